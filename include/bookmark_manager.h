@@ -1,20 +1,46 @@
 #ifndef BOOKMARK_MANAGER_H
 #define BOOKMARK_MANAGER_H
 
+#include "cbz_handler.h"
+
 // Initialize the SQLite database (create tables if needed)
 int init_bookmarks_db();
 
-// Checks if a bookmark exists for this file.
-int load_bookmark(const char *filepath);
+// Checks if a bookmark exists for this file. Returns the page, and in
+// out_offset (if set) how far into it the webtoon view was, as a share of
+// the page's height.
+int load_bookmark(const char *filepath, double *out_offset);
 
-// Saves the current page index for the given file.
-void save_bookmark(const char *filepath, int page_index);
+// Saves the current page index (and webtoon offset into it) for the given
+// file.
+void save_bookmark(const char *filepath, int page_index, double offset);
 
 // Close the database connection (call at app exit)
 void close_bookmarks_db();
 
-// Komga progress sync
-void save_komga_progress(const char *book_id, int page, int completed);
-int load_komga_progress(const char *book_id, int *out_page, int *out_completed);
+// Komga progress sync (offset as for bookmarks)
+void save_komga_progress(const char *book_id, int page, int completed,
+                         double offset);
+int load_komga_progress(const char *book_id, int *out_page, int *out_completed,
+                        double *out_offset);
+
+
+// Page index cache: the sorted page list of a CBZ, valid while the file
+// keeps the size and mtime it was built for. load_page_index() returns 0
+// and a malloc'd array on a hit, -1 on a miss.
+int load_page_index(const char *filepath, long long size, long long mtime,
+                    CbzPage **out_pages, int *out_count);
+void save_page_index(const char *filepath, long long size, long long mtime,
+                     const CbzPage *pages, int count);
+
+// Record page sizes measured since the index was saved (entries with w <= 0
+// are skipped)
+void save_page_sizes(const char *filepath, const PageSize *sizes, int count);
+
+// Page sizes of a Komga book measured on an earlier visit. Fills sizes
+// where known; returns how many were.
+int load_komga_page_sizes(const char *book_id, PageSize *sizes, int count);
+void save_komga_page_sizes(const char *book_id, const PageSize *sizes,
+                           int count);
 
 #endif
@@ -12,6 +12,7 @@ typedef enum {
 
 typedef struct {
   SDL_Texture *texture;
+  SDL_Surface *pixels; // decoded, waiting for its upload
   int width;
   int height;
 } CoverImage;
@@ -46,6 +47,7 @@ typedef struct {
   int series_current_page;
   int selected_series;
   CoverImage *series_covers;
+  unsigned series_cover_gen; // bumped when series_covers is replaced
 
   // Books data (current page)
   KomgaBook *books_list;
@@ -54,6 +56,7 @@ typedef struct {
   int books_current_page;
   int selected_book;
   CoverImage *book_covers;
+  unsigned book_cover_gen;
 
   // Grid layout
   int grid_cols;
@@ -72,13 +75,16 @@ typedef struct {
 } BrowserState;
 
 void browser_init(BrowserState *state);
-void browser_cleanup(BrowserState *state, SDL_Renderer *renderer);
+void browser_cleanup(BrowserState *state, AppContext *app);
 
 int browser_load_libraries(BrowserState *state, KomgaClient *client);
+
+// Cover thumbnails are decoded on app's decode pool and show up as
+// decode_pool_drain() delivers them.
 int browser_load_series(BrowserState *state, KomgaClient *client,
-                        SDL_Renderer *renderer, int page);
+                        AppContext *app, int page);
 int browser_load_books(BrowserState *state, KomgaClient *client,
-                       SDL_Renderer *renderer, int page);
+                       AppContext *app, int page);
 
 void browser_render(BrowserState *state, AppContext *app);
 BrowserResult browser_handle_event(BrowserState *state, SDL_Event *event,
@@ -1,6 +1,10 @@
 #ifndef CBZ_HANDLER_H
 #define CBZ_HANDLER_H
 
+#include "image_probe.h"
+#include "page_buffer.h"
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stddef.h>
 #include <zip.h>
 
@@ -12,17 +16,68 @@ typedef enum {
   MODE_MANHWA, // Vertical (Placeholder for future)
 } ReadMode;
 
+// Read-only mapping of a whole archive. Pages borrowed out of it hold a
+// reference, so it stays mapped until the book and the last of them let go.
 typedef struct {
-  char **filenames;
+  atomic_int refs;
+  const char *base;
+  size_t size;
+} CbzMapping;
+
+// One page of a book, in reading order. This is what the page index in
+// library.db stores per archive, so a known archive opens without its
+// central directory being read.
+typedef struct {
+  zip_uint64_t entry; // index in the archive's central directory
+  size_t offset;      // where the bytes start in the file if the entry is
+                      // stored uncompressed, 0 = read through libzip
+  size_t comp_size;   // bytes in the archive
+  size_t size;        // bytes once extracted
+  int width, height;  // image size, 0 until known
+} CbzPage;
+
+#define CBZ_HANDLE_POOL 4 // libzip handles kept open per book
+
+// libzip handles on a book's file. A handle is not thread-safe, so each is
+// lent to one thread at a time; a thread that finds none idle opens another.
+// Up to CBZ_HANDLE_POOL of them are kept for reuse, any more are closed
+// when given back.
+typedef struct {
+  pthread_mutex_t lock;
+  zip_t *idle[CBZ_HANDLE_POOL];
+  int idle_count;
+} CbzHandlePool;
+
+typedef struct {
+  char path[1024];
+  CbzPage *pages; // pages[page index]
   int count;
   int current_index;
-  zip_t *archive;
+  CbzHandlePool handles; // for pages that aren't mapped
   ReadMode mode;
+  CbzMapping *map; // NULL when the archive could not be mapped
 } MangaBook;
 
+// Open a CBZ: its page list comes from library.db when the file's size and
+// mtime match the cached index, and is built (and cached) otherwise.
 int open_cbz(const char *path, MangaBook *book);
 void close_cbz(MangaBook *book);
 char *get_image_data(MangaBook *book, size_t *size);
+
+// Read page index. Stored pages are copied out of the mapping, the rest
+// are extracted through a handle of the book's pool. pages is never
+// modified after open_cbz, so any number of threads may call this (and the
+// two below) concurrently; each extraction runs on a handle of its own.
+char *read_page_data(MangaBook *book, int index, size_t *out_size);
+
+// Page index as shared bytes: a view straight into the mapping for stored
+// entries (no copy, no read), otherwise read like read_page_data()
+PageBuffer *borrow_page_data(MangaBook *book, int index);
+
+// Size of page index read from its image header alone: a few bytes of the
+// mapping for stored pages, the first PROBE_HEAD_BYTES inflated otherwise.
+// Returns 0 on success.
+int probe_page_size(MangaBook *book, int index, PageSize *out);
 void next_page(MangaBook *book);
 void prev_page(MangaBook *book);
 
@@ -7,6 +7,11 @@ typedef struct {
   char komga_username[128];
   char komga_password[128];
   char download_path[1024];
+  int prefetch_connections; // [komga] prefetch_connections
+  int cache_budget_mb; // [cache] budget_mb
+  int strip_margin;    // [reader] strip_margin, % of the window height
+  int upload_budget_mb; // [reader] upload_budget_mb, texture uploads per
+                        // frame (0 = no limit)
 } AppConfig;
 
 void config_set_defaults(AppConfig *cfg);
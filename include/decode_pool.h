@@ -0,0 +1,79 @@
+#ifndef DECODE_POOL_H
+#define DECODE_POOL_H
+
+#include "page_buffer.h"
+#include <SDL2/SDL.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define DECODE_POOL_MAX_THREADS 16
+
+// Called on the main thread from decode_pool_drain() with the decoded image
+// (NULL if decoding failed). Return 1 to keep the surface (the callback then
+// owns it), 0 to have the pool free it. gen is handed back as given to
+// decode_pool_submit() so stale results can be ignored.
+typedef int (*DecodeDoneFn)(SDL_Renderer *renderer, void *user, int key,
+                            unsigned gen, SDL_Surface *surface);
+
+typedef struct DecodeJob {
+  PageBuffer *buf; // compressed image, one reference owned by the job
+  int max_w, max_h; // shrink the decoded image to fit, 0 = no limit
+  DecodeDoneFn done;
+  void *user;
+  int key;
+  unsigned gen;
+  SDL_Surface *surface;
+  int cancelled;
+  struct DecodeJob *next;
+} DecodeJob;
+
+// Decodes images on worker threads and hands the results back to the main
+// thread, which owns the renderer and creates the textures.
+typedef struct {
+  SDL_Renderer *renderer;
+  pthread_t threads[DECODE_POOL_MAX_THREADS];
+  int thread_count;
+
+  pthread_mutex_t lock;
+  pthread_cond_t work_cond;
+  DecodeJob *pending_head; // FIFO of jobs not started yet
+  DecodeJob *pending_tail;
+  DecodeJob *done_head;    // FIFO of finished jobs, drained by the main thread
+  DecodeJob *done_tail;
+  DecodeJob *active[DECODE_POOL_MAX_THREADS]; // job each worker is decoding
+  int workers_started;
+  int running;
+
+  // SDL event pushed when results are waiting, so an idle main loop blocked
+  // in SDL_WaitEvent* wakes up. At most one is queued at a time.
+  Uint32 wake_event; // (Uint32)-1 if SDL had no event number left
+  atomic_int wake_pending;
+} DecodePool;
+
+// threads <= 0 sizes the pool to the number of CPU cores. If no thread can
+// be started, jobs are decoded inline by decode_pool_drain().
+int decode_pool_init(DecodePool *pool, SDL_Renderer *renderer, int threads);
+void decode_pool_shutdown(DecodePool *pool);
+
+// Queue buf for decoding, downscaled to fit max_w x max_h (0 = no limit).
+// The reference to buf is consumed.
+void decode_pool_submit(DecodePool *pool, PageBuffer *buf, int max_w,
+                        int max_h, DecodeDoneFn done, void *user, int key,
+                        unsigned gen);
+
+// Forget every queued, running and finished job submitted with user
+void decode_pool_cancel(DecodePool *pool, void *user);
+
+// Same for the jobs submitted with user, key and gen only, e.g. a page the
+// reader has flipped past before it was decoded
+void decode_pool_cancel_job(DecodePool *pool, void *user, int key,
+                            unsigned gen);
+
+// Run the callbacks of finished jobs (main thread). Returns how many ran.
+int decode_pool_drain(DecodePool *pool);
+
+// Wake the main thread's event loop (any thread). Other background work
+// uses this too when it has something for the main thread.
+void decode_pool_wake(DecodePool *pool);
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef IMAGE_PROBE_H
+#define IMAGE_PROBE_H
+
+#include <stddef.h>
+
+#define PROBE_HEAD_BYTES 65536 // enough for a JPEG's SOF behind EXIF/ICC data
+
+// Pixel size of a page; w == 0 while unknown, -1 once it couldn't be told
+typedef struct {
+  int w, h;
+} PageSize;
+
+// Read an image's size from its header alone: PNG IHDR, JPEG SOF or WebP
+// (VP8, VP8L, VP8X). data may be just the start of the file. Returns 0 on
+// success, -1 if the format is unknown or the size lies beyond size bytes.
+int probe_image_size(const unsigned char *data, size_t size, PageSize *out);
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef JPEG_DECODE_H
+#define JPEG_DECODE_H
+
+#include <SDL2/SDL.h>
+#include <stddef.h>
+
+// Decode a JPEG straight into a surface of the given 32-bit format
+// (ARGB8888, ABGR8888, RGB888 or BGR888) using libjpeg's DCT scaling: the
+// image comes out at 1/2, 1/4 or 1/8 size when that is still at least as
+// large as it needs to be to fill max_w x max_h (0 = no limit), which is
+// much cheaper than decoding at full size and shrinking after. Returns NULL
+// if data is not a JPEG libjpeg can convert to RGB (e.g. CMYK), the format
+// is not one of the above, or the data is corrupt; fall back to the generic
+// loader then.
+SDL_Surface *jpeg_decode(const char *data, size_t size, int max_w, int max_h,
+                         Uint32 format);
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef KOMGA_CLIENT_H
 #define KOMGA_CLIENT_H
 
+#include "image_probe.h"
 #include <curl/curl.h>
 #include <stddef.h>
 
@@ -39,8 +40,17 @@ typedef struct {
   char *data;
   size_t size;
   size_t capacity;
+  size_t limit; // stop the transfer once this much arrived, 0 = no limit
 } HttpBuffer;
 
+// A page download driven by a caller-owned curl multi handle. The easy
+// handle is kept between transfers so connections can be reused.
+typedef struct {
+  CURL *easy;
+  struct curl_slist *headers;
+  HttpBuffer body;
+} KomgaTransfer;
+
 // Lifecycle
 int komga_init(KomgaClient *client, const char *base_url,
                const char *api_key, const char *username,
@@ -71,6 +81,32 @@ char *komga_get_book_thumbnail(KomgaClient *client, const char *book_id,
                                size_t *out_size);
 char *komga_get_page(KomgaClient *client, const char *book_id, int page_num,
                      size_t *out_size);
+char *komga_get_page_thumbnail(KomgaClient *client, const char *book_id,
+                               int page_num, size_t *out_size);
+
+// First max_bytes of a page (a Range request), enough to read the image
+// size from its header. Should the server ignore the range, the transfer is
+// cut short once max_bytes arrived.
+char *komga_get_page_head(KomgaClient *client, const char *book_id,
+                          int page_num, size_t max_bytes, size_t *out_size);
+
+// Page sizes Komga measured when it analysed the book, from its page list.
+// Fills sizes[0..count) where known (w stays 0 where not). Returns 0 on
+// success.
+int komga_get_page_sizes(KomgaClient *client, const char *book_id,
+                         PageSize *sizes, int count);
+
+// Multi-handle page transfers: begin configures t->easy for the page (the
+// caller adds it to its multi handle); finish checks the outcome and returns
+// the body (caller must free()) or NULL. cleanup releases the easy handle.
+int komga_transfer_begin_page(KomgaClient *client, KomgaTransfer *t,
+                              const char *book_id, int page_num);
+// Same for the page's thumbnail (a few hundred pixels wide, a small JPEG)
+int komga_transfer_begin_page_thumbnail(KomgaClient *client, KomgaTransfer *t,
+                                        const char *book_id, int page_num);
+char *komga_transfer_finish(KomgaTransfer *t, CURLcode result,
+                            size_t *out_size);
+void komga_transfer_cleanup(KomgaTransfer *t);
 
 // Download full CBZ to disk. Returns 0 on success.
 int komga_download_book(KomgaClient *client, const char *book_id,
@@ -0,0 +1,34 @@
+#ifndef PAGE_BUFFER_H
+#define PAGE_BUFFER_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+// Immutable, reference-counted page bytes shared between the fetch/read
+// threads, the page cache and the decoder. Never modify data after wrapping.
+typedef struct {
+  atomic_int refs;
+  size_t size;
+  const char *data;
+  void (*release)(void *owner); // for borrowed bytes, NULL if data is ours
+  void *owner;
+} PageBuffer;
+
+// Take ownership of a malloc'd buffer (no copy). Returns a buffer holding
+// one reference, or NULL (data is freed) on failure.
+PageBuffer *page_buffer_wrap(char *data, size_t size);
+
+// Wrap bytes that belong to someone else, e.g. a page inside a mapped
+// archive (no copy). release(owner) runs instead of free() when the last
+// reference goes; data must stay valid until then. Returns NULL (release
+// has run) on failure.
+PageBuffer *page_buffer_borrow(const char *data, size_t size,
+                               void (*release)(void *owner), void *owner);
+
+PageBuffer *page_buffer_retain(PageBuffer *buf);
+
+// Drop one reference; frees (or hands back) the bytes when the last one
+// goes.
+void page_buffer_release(PageBuffer *buf);
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef PAGE_CACHE_H
+#define PAGE_CACHE_H
+
+#include "page_buffer.h"
+#include <stddef.h>
+
+#define PAGE_CACHE_DEFAULT_BUDGET (256u * 1024 * 1024)
+
+typedef struct CachedPage {
+  int index;
+  PageBuffer *buf; // one reference owned by the cache
+  struct CachedPage *prev; // resident list, in page order
+  struct CachedPage *next;
+} CachedPage;
+
+typedef struct {
+  unsigned long hits;
+  unsigned long misses;
+  unsigned long evictions;
+  size_t peak_bytes;
+} PageCacheStats;
+
+// Byte-budgeted cache of compressed pages. Lookups go through slots and
+// take O(1). Resident pages are also kept in page order, so the eviction
+// victim is always the first or the last of them: O(1) per eviction.
+// Storing a page walks slots back to its resident predecessor, which is
+// next to it while pages arrive around the reader. Not thread-safe: the
+// owner serialises access (PageProvider uses cache_mutex).
+typedef struct {
+  CachedPage **slots; // slots[page index] -> entry, NULL if not resident
+  int page_count;
+  CachedPage *head;   // lowest resident page
+  CachedPage *tail;   // highest resident page
+  int entry_count;
+  size_t bytes_used;
+  size_t budget;
+
+  // Reading position, used to pick eviction victims
+  int position;
+  int direction; // +1 reading forward, -1 reading backward
+
+  PageCacheStats stats;
+} PageCache;
+
+int page_cache_init(PageCache *c, int page_count, size_t budget);
+void page_cache_free(PageCache *c);
+
+// Update the reader position. Direction follows the last move.
+void page_cache_set_position(PageCache *c, int index);
+
+// Lookup for a reader request: counts a hit or a miss.
+CachedPage *page_cache_get(PageCache *c, int index);
+
+// Lookup without touching the counters (prefetch bookkeeping).
+int page_cache_contains(const PageCache *c, int index);
+
+// Hand one reference to buf over to the cache (no copy), evicting pages
+// behind the reader first. The reference is consumed even when the page is
+// not kept. Returns 0 if stored, -1 if the page was not worth keeping.
+int page_cache_store(PageCache *c, int index, PageBuffer *buf);
+
+#endif
@@ -2,7 +2,11 @@
 #define PAGE_PROVIDER_H
 
 #include "cbz_handler.h"
+#include "config.h"
 #include "komga_client.h"
+#include "page_buffer.h"
+#include "page_cache.h"
+#include "prefetch_policy.h"
 #include <pthread.h>
 #include <stddef.h>
 
@@ -11,42 +15,163 @@ typedef enum {
   SOURCE_KOMGA_STREAM,
 } PageSourceType;
 
-#define PAGE_CACHE_SIZE 20
-#define PREFETCH_AHEAD 5
+#define PREFETCH_MAX_CONNECTIONS 16
+#define FETCH_RESERVED_SLOTS 2 // kept free of speculative downloads
+#define FETCH_SLOT_COUNT (PREFETCH_MAX_CONNECTIONS + FETCH_RESERVED_SLOTS)
+#define FETCH_QUEUE_SIZE 8
+
+#define LOCAL_WORKERS 2       // read/decode threads for local books
+#define LOCAL_DECODE_AHEAD 3  // pages kept decoded in the reading direction
+#define LOCAL_DECODE_BEHIND 1 // ...and against it
+
+#define PROBE_WAKE_BATCH 32 // pages measured between wakeups of the app
+
+// Decoder hooks. The provider stays free of SDL: the app hands it a
+// thread-safe decoder and the matching destructor for its images. The
+// decoder shrinks images to fit max_w x max_h (0 = no limit).
+typedef void *(*PageDecodeFn)(const char *data, size_t size, int max_w,
+                              int max_h);
+typedef void (*PageFreeFn)(void *image);
+
+// Called from the background threads whenever a page finished loading (or
+// failed), so an idle UI knows to look again. Must be thread-safe.
+typedef void (*PageWakeFn)(void *user);
+
+// Decode state of one page of a local book (guarded by cache_mutex)
+typedef struct {
+  void *image;          // decoded page, NULL until a worker produced it
+  unsigned size_gen;    // decode_gen image was decoded for
+  int pins;             // borrowers currently using image
+  unsigned char busy;   // a worker is reading or decoding this page
+  unsigned char failed; // read or decode failed, not retried while nearby
+  unsigned char no_room; // cache refused the bytes, skip it for read-ahead
+} LocalPage;
+
+// Komga-side state of one page (guarded by cache_mutex)
+typedef struct {
+  PageBuffer *preview;     // Komga's thumbnail of the page, NULL until
+                           // fetched; dropped once the page itself is cached
+  int preview_requested;   // thumbnail fetched (or tried) already
+  int failed_at;           // current_index when its download last failed,
+                           // -1 if it didn't; not retried from there
+} RemotePage;
+
+// Scrubber thumbnail of one page (guarded by cache_mutex)
+typedef enum {
+  THUMB_NONE,   // not wanted
+  THUMB_WANTED, // queued for the side thread
+  THUMB_BUSY,   // being read and decoded
+  THUMB_READY,  // decoded, waiting to be taken
+  THUMB_FAILED, // read or decode failed, not retried
+} ThumbState;
+
+// Lower value = served first
+typedef enum {
+  FETCH_VISIBLE,     // page on screen
+  FETCH_ADJACENT,    // facing page / next page in the strip
+  FETCH_SPECULATIVE, // read-ahead
+} FetchPriority;
 
 typedef struct {
-  int index;
-  char *data;
-  size_t size;
-} CachedPage;
+  int index; // -1 when unused
+  FetchPriority priority;
+} FetchRequest;
+
+// One concurrent page download of the fetch engine
+typedef struct {
+  KomgaTransfer xfer;
+  int index; // page being fetched, -1 when idle
+  int preview; // fetching the page's thumbnail rather than the page
+  FetchPriority priority;
+  atomic_int cancel; // polled by the transfer's xferinfo callback
+} FetchSlot;
 
 typedef struct {
   PageSourceType type;
 
   // For SOURCE_LOCAL_CBZ:
-  MangaBook local_book;
+  MangaBook local_book; // read by every thread, see read_page_data()
+  LocalPage *local_pages; // local_pages[page index]
+  pthread_t local_workers[LOCAL_WORKERS];
+  int worker_count;
 
   // For SOURCE_KOMGA_STREAM:
   KomgaClient *client; // borrowed, not owned (main thread only)
   char book_id[64];
+  RemotePage *remote_pages; // remote_pages[page index]
+  int preview_wanted;       // page whose thumbnail to fetch next, -1 = none
 
   // Unified fields
   int current_index;
   int count;
   ReadMode read_mode;
 
-  // Page cache for streaming
-  CachedPage cache[PAGE_CACHE_SIZE];
+  // Page cache for streaming (byte-budgeted, see page_cache.h)
+  PageCache cache;
 
-  // Prefetch thread state (Komga only)
-  pthread_t prefetch_thread;
+  // Read-ahead/read-behind window sizing (guarded by cache_mutex)
+  PrefetchPolicy policy;
+  int span_ahead;  // pages the screen needs around current_index; read-ahead
+  int span_behind; // always covers at least these
+
+  // Size local workers decode pages at (guarded by cache_mutex). Images
+  // from an older decode_gen are dropped and decoded again.
+  int decode_w, decode_h;
+  unsigned decode_gen;
+
+  // Background work, shared by both sources
   pthread_mutex_t cache_mutex;
-  pthread_cond_t prefetch_cond;
-  KomgaClient prefetch_client; // separate curl handle for prefetch thread
-  int prefetch_running;
+  pthread_cond_t prefetch_cond; // wakes the engine / local workers
+  pthread_cond_t fetch_done;    // a page finished loading or failed
+
+  // Fetch engine state (Komga only). One thread runs every page download,
+  // requested pages first, read-ahead with whatever capacity is left.
+  pthread_t prefetch_thread;
+  KomgaClient prefetch_client; // credentials for the engine's transfers
+  CURLM *multi;                // drives all downloads concurrently
+  FetchSlot fetch_slots[FETCH_SLOT_COUNT];
+  FetchRequest fetch_queue[FETCH_QUEUE_SIZE];
+  int max_connections; // cap on concurrent speculative downloads
+  int prefetch_running; // engine or local workers are up
+
+  // Side thread: decodes scrubber thumbnails and measures pages, away from
+  // the page loads so neither queues behind them. Started on first use.
+  pthread_t side_thread;
+  pthread_cond_t side_cond; // wakes the side thread
+  KomgaClient side_client;  // credentials for its requests (Komga only)
+  int side_running;
+  int side_failed; // could not be started, don't try again
+
+  // Scrubber thumbnails, allocated when the first one is wanted
+  unsigned char *thumb_state; // ThumbState per page
+  void **thumbs;              // decoded thumbnail per page while READY
+  int thumb_focus;            // page the scrubber is on; nearest go first
+  int thumb_w, thumb_h;       // size thumbnails are decoded to fit
+
+  // Size of every page as stored, read from the image headers (or Komga's
+  // page list) so layout doesn't have to wait for decodes. w = 0 while
+  // unknown, -1 if the header could not be read. page_sizes belongs to the
+  // main thread, see provider_sync_sizes().
+  PageSize *page_sizes;
+  PageSize *probed_sizes; // filled in by the side thread (cache_mutex)
+  int probe_cursor;       // pages before it have been measured (or failed)
+  int probes_since_wake;
+  int sizes_changed;  // probed_sizes has news for page_sizes
+  int sizes_measured; // something was measured: save it on close
 } PageProvider;
 
-// Open from local CBZ file
+// Apply config.ini tunables to providers opened afterwards
+void provider_configure(const AppConfig *cfg);
+
+// Install the page decoder used by local workers. Without one, local books
+// only get byte read-ahead.
+void provider_set_decoder(PageDecodeFn decode, PageFreeFn free_image);
+
+// Install the wakeup hook for pages that land in the background
+void provider_set_wakeup(PageWakeFn wake, void *user);
+
+// Open from local CBZ file. Worker threads read the pages around
+// current_index into the cache and decode the nearest ones.
 int provider_open_local(PageProvider *p, const char *cbz_path);
 
 // Open from Komga book (fetches book details for page count)
@@ -56,9 +181,76 @@ int provider_open_komga(PageProvider *p, KomgaClient *client,
 // Get page image data at index. Caller must free() the returned buffer.
 char *provider_get_page(PageProvider *p, int index, size_t *out_size);
 
-// Signal the prefetch thread that current_index changed
+// Borrow page image data at index without copying. The buffer is shared
+// with the cache and must not be modified; give it back with
+// provider_release_page(). Returns NULL on failure. For Komga books a miss
+// is queued ahead of read-ahead (visible page first, then its neighbours)
+// and waited for.
+PageBuffer *provider_borrow_page(PageProvider *p, int index);
+void provider_release_page(PageBuffer *buf);
+
+// Like provider_borrow_page() but never blocks: returns NULL unless the page
+// is already cached, and has it loaded in the background instead.
+PageBuffer *provider_try_borrow_page(PageProvider *p, int index);
+
+// For a Komga page that is not cached yet: request it as visible, along
+// with its thumbnail, and borrow the thumbnail once it is there (NULL until
+// then, or for local books). The thumbnail is a single small request, so it
+// can be shown long before a large page finishes downloading.
+PageBuffer *provider_borrow_preview(PageProvider *p, int index);
+
+// Borrow the decoded image of a page, waiting (if wait is set) when a worker
+// is decoding it right now. Returns NULL when no decoded image is available
+// (Komga books, no decoder, or the page is not near the reader); fall back
+// to borrowing the bytes then. Give it back with provider_release_decoded().
+void *provider_borrow_decoded(PageProvider *p, int index, int wait);
+void provider_release_decoded(PageProvider *p, int index);
+
+// Have the thumbnail of a page decoded to fit max_w x max_h in the
+// background. Local books read the page from the archive (or the cache),
+// Komga books fetch the server's page thumbnail. Does nothing without a
+// decoder.
+void provider_want_thumbnail(PageProvider *p, int index, int max_w,
+                             int max_h);
+
+// Serve wanted thumbnails nearest to focus first, and forget those outside
+// first..last that have not been started
+void provider_focus_thumbnails(PageProvider *p, int first, int last,
+                               int focus);
+
+// Take the decoded thumbnail of a page once it is ready (NULL until then).
+// The caller owns the image and frees it with the decoder's destructor;
+// wanting the page again decodes it anew.
+void *provider_take_thumbnail(PageProvider *p, int index);
+
+// Bring page_sizes up to date with what the side thread has measured since.
+// Main thread only. Returns 1 if any size changed.
+int provider_sync_sizes(PageProvider *p);
+
+// Queue a page download without waiting for it (Komga only)
+void provider_request_page(PageProvider *p, int index, FetchPriority priority);
+
+// Signal the background threads that current_index changed. Downloads that
+// are no longer near the reader are cancelled.
 void provider_notify_prefetch(PageProvider *p);
 
+// Report scrolling (in pages, negative = up) so read-ahead can keep pace
+void provider_note_scroll(PageProvider *p, double pages);
+
+// Pages on screen (or about to be) besides the current one, e.g. the rest
+// of the webtoon strip. Read-ahead never stops short of them.
+void provider_set_span(PageProvider *p, int behind, int ahead);
+
+// Size pages are decoded at from now on (0 = no limit). Decoded images of
+// another size are dropped; their bytes stay cached for the re-decode.
+void provider_set_decode_size(PageProvider *p, int max_w, int max_h);
+
+// Current read-ahead/read-behind window sizes, in pages
+void provider_prefetch_window(PageProvider *p, int *ahead, int *behind);
+
+// Snapshot of the page cache counters
+PageCacheStats provider_cache_stats(PageProvider *p);
+
 // Close and free resources
 void provider_close(PageProvider *p);
 
@@ -0,0 +1,54 @@
+#ifndef PREFETCH_POLICY_H
+#define PREFETCH_POLICY_H
+
+#include <stddef.h>
+
+#define PREFETCH_MIN_AHEAD 2
+#define PREFETCH_MAX_AHEAD 40
+#define PREFETCH_MAX_BEHIND 10
+
+// Sizes the read-ahead/read-behind windows from how the reader actually
+// reads: time spent per page, scroll speed, and observed download speed.
+// Not thread-safe: the owner serialises access.
+typedef struct {
+  // Page turns
+  int last_index;
+  double last_move_time;
+  double dwell_ema;     // seconds per page
+  double backward_ema;  // share of recent moves that went backward
+
+  // Webtoon scrolling
+  double scroll_accum;  // pages scrolled since the last sample
+  double scroll_sample_time;
+  double last_scroll_time;
+  double scroll_rate_ema; // pages per second
+
+  // Downloads
+  double throughput_ema; // bytes per second per download
+  double page_size_ema;  // bytes
+
+  // Current windows (read by the prefetcher, exposed for instrumentation)
+  int ahead;
+  int behind;
+} PrefetchPolicy;
+
+void prefetch_policy_init(PrefetchPolicy *pp, int start_index);
+
+// The reader is now on page index
+void prefetch_policy_note_position(PrefetchPolicy *pp, int index);
+
+// The reader scrolled by this many pages (negative = up)
+void prefetch_policy_note_scroll(PrefetchPolicy *pp, double pages);
+
+// A page of this size took this long to arrive (network or disk)
+void prefetch_policy_note_download(PrefetchPolicy *pp, size_t bytes,
+                                   double seconds);
+
+// Recompute ahead/behind so the reader never outruns the prefetcher,
+// without planning more pages than fit in cache_budget.
+void prefetch_policy_update(PrefetchPolicy *pp, size_t cache_budget);
+
+// Monotonic clock in seconds
+double prefetch_now(void);
+
+#endif
@@ -2,6 +2,11 @@
 #define RENDER_ENGINE_H
 
 #include "cbz_handler.h"
+#include "decode_pool.h"
+#include "scrubber.h"
+#include "strip_layout.h"
+#include "text_cache.h"
+#include "texture_pool.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 
@@ -20,23 +25,174 @@ typedef enum {
 
 typedef enum { DIR_MANGA, DIR_COMIC } PageDir;
 
+#define TEXTURE_RING_SIZE 32
+#define TEXTURE_RING_KEEP 2 // pages kept uploaded beyond the visible slots
+#define STRIP_MAX_PAGES (TEXTURE_RING_SIZE - 2 * TEXTURE_RING_KEEP)
+
+#define PAGE_TILE_HEIGHT 2048 // lowered to the renderer's texture limit
+#define PAGE_MAX_TILES 32     // taller pages get taller tiles
+#define DECODE_RESIZE_DELAY_MS 150 // window size must hold this long before
+                                   // pages are decoded again at the new size
+#define PAGE_PREVIEW_SCALE 8 // local stand-ins are decoded at 1/8 size
+
+// One page of the sliding window. Pages are split into horizontal tiles so
+// tall webtoon pages stay under the GPU's texture size limit; a page taller
+// than one tile keeps its decoded pixels and uploads only the tiles near the
+// viewport. Uploads are paced by the per-frame upload budget, so a decoded
+// page may wait a frame or two with its pixels before it has a texture.
+typedef struct {
+  SDL_Texture *tiles[PAGE_MAX_TILES]; // NULL when not uploaded
+  int tile_count;      // 0 while the page is still decoding
+  int tile_h;          // pixel rows per tile (the last one may be shorter)
+  int w, h;            // page size in pixels
+  SDL_Surface *pixels; // kept for multi-tile pages and until uploaded
+  int page;            // page held or being decoded, -1 when empty
+  unsigned gen;        // bumped whenever the entry changes hands
+  int preview; // 1: holds (or awaits) a low-resolution stand-in and the
+               // page itself is still to load, 2: ...and is decoding
+} PageTexture;
+
 typedef struct {
   SDL_Window *window;
   SDL_Renderer *renderer;
 
-  // Sliding Window Buffer
-  SDL_Texture *tex_prev; // Index - 1
-  SDL_Texture *tex_curr; // Index (Current)
-  SDL_Texture *tex_next; // Index + 1
+  // Sliding Window Buffer: ring[page % TEXTURE_RING_SIZE]. Slots are
+  // relative to slot_page (-1=Prev, 0=Curr, 1=Next, further out for the
+  // webtoon strip), so stepping a page keeps the neighbours' textures and
+  // only the newly exposed page loads.
+  PageTexture ring[TEXTURE_RING_SIZE];
+  int slot_page;  // page shown in slot 0
+  int slot_first; // visible slots, first <= 0 <= last
+  int slot_last;
+  int strip_margin; // webtoon pages kept loaded beyond the viewport, in %
+                    // of its height
+  int tile_height;  // PAGE_TILE_HEIGHT capped to the renderer's limit
+
+  // Stored size of each page of the book, where measured (the provider's
+  // page_sizes, see set_page_sizes()). The strip is laid out with them, so
+  // pages take their place before they are decoded.
+  const PageSize *page_sizes;
+  int page_count;
+
+  // Webtoon layout of the whole book for the output size and scale mode it
+  // was built for; rebuilt on first use after any of them changed
+  StripLayout strip;
+  int strip_stale; // page sizes or an unmeasured page's texture changed
+  int strip_w, strip_h;
+  ManhwaScale strip_scale;
+
+  // Pages are decoded at most this large (output pixels, so HiDPI included;
+  // 0 = no limit), see update_decode_size()
+  int decode_w, decode_h;
+  int resize_pending; // output size changed, waiting for it to settle
+  int pending_w, pending_h;
+  Uint32 pending_since;
+
+  TexturePool textures; // page tiles, recycled between pages
+
+  // Bytes of texture uploads a frame may make (0 = no limit) and what is
+  // left of it in the current one, see upload_budget_take()
+  size_t upload_budget;
+  size_t upload_left;
 
   TTF_Font *font;
+  TextCache text; // every string drawn on screen goes through here
+
+  Scrubber scrubber; // page timeline, drawn over the reader while open
+
+  // Off-thread image decoding; drain it once per frame
+  DecodePool decode_pool;
+
+  // Set when the screen no longer matches the last frame (input, a page
+  // arriving, a resize); cleared by render_frame(). Loops only draw, and
+  // otherwise sleep in SDL_WaitEventTimeout, while it is set.
+  int dirty;
+
+  // Software renderer (no GPU). Pages are decoded at exactly the size they
+  // are shown and drawn with plain blits. Webtoon frames are drawn into a
+  // target texture and copied to the window; one that differs from the
+  // last only in its scroll position starts as the last frame's rows,
+  // copied over by the difference, and draws just the rows that scrolled in.
+  int software;
+  SDL_Texture *frame_tex[2]; // strip frames, alternately
+  int frame_cur;             // the one holding the last frame
+  int frame_reusable;        // which is a complete strip frame
+  int frame_page;            // ...drawn with this slot_page,
+  int frame_scroll;          // this scroll_y,
+  ManhwaScale frame_scale;   // this scale mode
+  int frame_w, frame_h;      // and this output size
 } AppContext;
 
 int init_sdl(AppContext *ctx, int width, int height);
 void cleanup_sdl(AppContext *ctx);
 
-// Slot: -1=Prev, 0=Curr, 1=Next
-void load_texture_to_slot(AppContext *ctx, char *buffer, size_t size, int slot);
+// Show page in slot 0 and the slots first..last around it. Textures of
+// pages further out than TEXTURE_RING_KEEP are released.
+void set_slot_window(AppContext *ctx, int page, int first, int last);
+
+// Hand over the page sizes of the book being read (NULL = none). The
+// array must stay valid until the next call or clear_slots().
+void set_page_sizes(AppContext *ctx, const PageSize *sizes, int count);
+
+// Webtoon positions. The strip is laid out over every page of the book,
+// measured or not, so a position is either an absolute offset from the top
+// of the strip or a page plus an offset into it (scroll_y); these convert
+// between the two in O(log n). Pages neither measured nor decoded count at
+// the average height of the others until they are.
+long long strip_position(AppContext *ctx, ManhwaScale scale_mode, int page,
+                         int offset);
+int strip_locate(AppContext *ctx, ManhwaScale scale_mode, long long pos,
+                 int *offset);
+int strip_page_height(AppContext *ctx, ManhwaScale scale_mode, int page);
+long long strip_length(AppContext *ctx, ManhwaScale scale_mode);
+
+// Slots the webtoon strip needs around page to cover the viewport plus
+// strip_margin, at most STRIP_MAX_PAGES in total
+void strip_span(AppContext *ctx, ManhwaScale scale_mode, int scroll_y,
+                int page, int count, int *first, int *last);
+
+// Whether page is uploaded or on its way (no need to load it again)
+int page_texture_loaded(AppContext *ctx, int page);
+
+// Show an already decoded page; it is uploaded with the next frames. The
+// surface stays owned by the caller (the entry keeps a copy).
+void load_surface_to_page(AppContext *ctx, SDL_Surface *surface, int page);
+
+// Decode buf on the decode pool; the texture appears once
+// decode_pool_drain() runs after the decode finished. Consumes the reference
+// to buf.
+void queue_page_decode(AppContext *ctx, PageBuffer *buf, int page);
+
+// Decode an image from memory into the renderer's native pixel format
+// (chosen by init_sdl), shrunk to fit
+// max_w x max_h (0 = no limit). Touches no renderer state, so it is safe to
+// call from worker threads.
+SDL_Surface *decode_page(const char *buffer, size_t size, int max_w,
+                         int max_h);
+
+// Follow the output size and view: pages are decoded no larger than they
+// are shown. Returns 1 when the size changed, in which case the textures
+// were dropped and the visible pages need loading again.
+int update_decode_size(AppContext *ctx, ViewMode mode, ManhwaScale scale_mode);
+
+// Start a frame's upload budget; render_frame() and browser_render() call
+// this before drawing
+void upload_budget_reset(AppContext *ctx);
+
+// Whether an upload of bytes still fits this frame; it is counted if so.
+// The first upload of a frame always fits, so nothing larger than the
+// budget waits forever. A refused upload marks the context dirty so the
+// next frame picks it up.
+int upload_budget_take(AppContext *ctx, size_t bytes);
+
+// Show a low-resolution stand-in for page until queue_page_decode() brings
+// the page itself: a thumbnail as it is or, with reduce, buf decoded at
+// 1/PAGE_PREVIEW_SCALE of the decode size (JPEG only, where libjpeg makes
+// that cheap). Consumes the reference to buf.
+void queue_preview_decode(AppContext *ctx, PageBuffer *buf, int page,
+                          int reduce);
+
+// Forget every page texture (the book changed)
 void clear_slots(AppContext *ctx);
 
 // Helper to get the rendered height of a specific slot
@@ -48,9 +204,4 @@ void render_frame(AppContext *ctx, const char *overlay_text,
                   const char *popup_message); 
 
 void render_popup(AppContext *ctx, const char *message);
-
-// Helper: create a text texture (caller must SDL_DestroyTexture)
-SDL_Texture *render_text_texture(SDL_Renderer *renderer, TTF_Font *font,
-                                 const char *text, SDL_Color color, int *out_w,
-                                 int *out_h);
 #endif
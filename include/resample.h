@@ -0,0 +1,17 @@
+#ifndef RESAMPLE_H
+#define RESAMPLE_H
+
+#include <SDL2/SDL.h>
+
+// Downscale a 32-bit surface (e.g. ARGB8888) to dst_w x dst_h with an area
+// average (box) filter: every destination pixel is the coverage-weighted
+// mean of the source pixels under it. Uses SSE2 when the compiler targets
+// it. Returns a new surface in src's format, or NULL on failure; the
+// source is left alone. Only meant for shrinking (dst <= src).
+SDL_Surface *resample_area(SDL_Surface *src, int dst_w, int dst_h);
+
+// Size of a w x h image shrunk to fit max_w x max_h (0 = unbounded),
+// keeping its aspect ratio. Returns 0 if no shrinking is needed.
+int resample_fit(int w, int h, int max_w, int max_h, int *out_w, int *out_h);
+
+#endif
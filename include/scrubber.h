@@ -0,0 +1,74 @@
+#ifndef SCRUBBER_H
+#define SCRUBBER_H
+
+#include "text_cache.h"
+#include <SDL2/SDL.h>
+
+#define SCRUB_THUMB_W 64    // thumbnails are decoded to fit this box
+#define SCRUB_THUMB_H 96
+#define SCRUB_ATLAS_SIZE 2048 // atlas texture edge, capped to the renderer's
+#define SCRUB_MAX_CELLS                                                        \
+  ((SCRUB_ATLAS_SIZE / SCRUB_THUMB_W) * (SCRUB_ATLAS_SIZE / SCRUB_THUMB_H))
+
+// Timeline bar for jumping through a book. Page thumbnails live in one
+// atlas texture, direct-mapped by page number, so dragging across hundreds
+// of pages draws a row of small copies out of a single texture and never
+// touches the page pipeline. The page is only loaded once the scrub is
+// committed.
+typedef struct {
+  int open;
+  int index;    // page under the scrubber
+  int count;    // pages in the book
+  int dragging; // left button held: 1 on a thumbnail, 2 on the track
+
+  // Layout of the last frame (output pixels), for hit tests
+  SDL_Rect bar;   // whole bar, 0 x 0 when not drawn
+  SDL_Rect row;   // the thumbnails
+  SDL_Rect track; // the position track under them
+  int first;      // page of the leftmost thumbnail
+  int shown;      // thumbnails in the row
+
+  SDL_Texture *atlas; // created with the first thumbnail, in its format
+  int cols, cells;    // atlas layout
+  int cell_page[SCRUB_MAX_CELLS]; // page held by each cell, -1 = none
+  SDL_Point cell_size[SCRUB_MAX_CELLS]; // thumbnail size in the cell
+} Scrubber;
+
+void scrubber_init(Scrubber *s);
+void scrubber_free(Scrubber *s);
+
+// A new book: forget the thumbnails but keep the atlas texture
+void scrubber_reset(Scrubber *s);
+
+void scrubber_open(Scrubber *s, int index, int count);
+void scrubber_close(Scrubber *s);
+
+// Move to page index (clamped). Returns 1 if it moved.
+int scrubber_set(Scrubber *s, int index);
+
+// Pages whose thumbnails to ask for: the whole book if it fits the atlas,
+// otherwise those the bar shows now or after a short scrub either way.
+// Empty (first > last) while closed.
+void scrubber_range(const Scrubber *s, int *first, int *last);
+
+// Whether page's thumbnail is in the atlas
+int scrubber_has(const Scrubber *s, int page);
+
+// Copy a decoded thumbnail into page's cell of the atlas. The surface
+// stays owned by the caller. Returns 0 on success.
+int scrubber_store(Scrubber *s, SDL_Renderer *renderer, int page,
+                   const SDL_Surface *thumb);
+
+// Draw the bar along the bottom of the output
+void scrubber_draw(Scrubber *s, SDL_Renderer *renderer, TextCache *text);
+
+// Mouse input, in output pixels. Pressing a thumbnail picks its page,
+// pressing the track starts a drag that follows the pointer along it.
+// scrubber_press() and scrubber_motion() return 1 if the position moved;
+// scrubber_release() returns 1 if a press on the bar ended, which commits
+// the scrub.
+int scrubber_press(Scrubber *s, int x, int y);
+int scrubber_motion(Scrubber *s, int x);
+int scrubber_release(Scrubber *s);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef STRIP_LAYOUT_H
+#define STRIP_LAYOUT_H
+
+// Where every page of a webtoon strip starts, as prefix sums of the pages'
+// on-screen heights. A position in the strip is then either one absolute
+// offset from its top or a page plus an offset into it, and either turns
+// into the other in O(log n). Building it is the owner's business: size it
+// with strip_layout_reserve() and fill top[1..count].
+typedef struct {
+  long long *top; // top[i]: offset of page i; top[count]: strip length
+  int count;      // pages laid out
+  int capacity;   // pages top has room for
+} StripLayout;
+
+void strip_layout_init(StripLayout *l);
+void strip_layout_free(StripLayout *l);
+
+// Make room for count pages and set count. Returns 0 on success.
+int strip_layout_reserve(StripLayout *l, int count);
+
+// Absolute offset of a point offset pixels into page (clamped to the
+// strip's pages; offset may run past the page either way)
+long long strip_layout_offset(const StripLayout *l, int page, int offset);
+
+// Page at absolute offset pos and how far into it pos lies. Positions
+// before the strip land on the first page, those past its end on the last
+// one (with an offset beyond its height). Returns 0 for an empty strip.
+int strip_layout_locate(const StripLayout *l, long long pos, int *offset);
+
+// On-screen height of page, 0 outside the strip
+int strip_layout_height(const StripLayout *l, int page);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#define TEXT_CACHE_SIZE 128 // rendered strings kept, least recently used go
+
+typedef struct {
+  SDL_Texture *texture; // NULL when the entry is free
+  char *text;           // string as given (before truncation)
+  SDL_Color color;
+  int max_w; // width the text was truncated to fit, 0 = none
+  int w, h;
+  Uint32 hash;
+  unsigned last_used;
+} TextEntry;
+
+// Rendered string textures keyed by text, colour and truncation width, so
+// overlays, menus and labels are rasterised once instead of every frame
+typedef struct {
+  SDL_Renderer *renderer;
+  TTF_Font *font; // borrowed; NULL disables text
+  TextEntry entries[TEXT_CACHE_SIZE];
+  unsigned clock;
+} TextCache;
+
+void text_cache_init(TextCache *tc, SDL_Renderer *renderer, TTF_Font *font);
+void text_cache_clear(TextCache *tc);
+
+// Texture of text in color, truncated with "..." to max_w pixels if it is
+// wider (0 = no limit). Rendered on first use and reused afterwards. The
+// texture stays owned by the cache and is only valid until the next call.
+// Returns NULL for empty text or without a font.
+SDL_Texture *text_cache_get(TextCache *tc, const char *text, SDL_Color color,
+                            int max_w, int *out_w, int *out_h);
+
+// Draw text with its top-left corner at x, y
+void text_cache_draw(TextCache *tc, const char *text, SDL_Color color, int x,
+                     int y, int max_w);
+
+#endif
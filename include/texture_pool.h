@@ -0,0 +1,47 @@
+#ifndef TEXTURE_POOL_H
+#define TEXTURE_POOL_H
+
+#include <SDL2/SDL.h>
+
+#define TEXTURE_POOL_IDLE 24  // unused textures kept around for reuse
+#define TEXTURE_POOL_ALIGN 64 // texture sizes are rounded up to this
+
+typedef struct {
+  SDL_Texture *texture;
+  int w, h; // allocated size
+} PoolTexture;
+
+// Streaming textures in the renderer's native format, recycled instead of
+// destroyed. Pages of similar size (they are all decoded to fit the same
+// window) land in the same textures, so turning pages allocates nothing on
+// the GPU. A texture may be larger than the image in it; draw it with a
+// source rect of the image size.
+typedef struct {
+  SDL_Renderer *renderer;
+  Uint32 format;
+  int max_w, max_h; // renderer's texture size limit, 0 = unknown
+  PoolTexture idle[TEXTURE_POOL_IDLE]; // oldest first
+  int idle_count;
+  int created; // textures allocated / handed out again, for tuning
+  int reused;
+} TexturePool;
+
+void texture_pool_init(TexturePool *pool, SDL_Renderer *renderer,
+                       Uint32 format, int max_w, int max_h);
+void texture_pool_clear(TexturePool *pool);
+
+// A texture of at least w x h, recycled when one of a fitting size is idle
+SDL_Texture *texture_pool_acquire(TexturePool *pool, int w, int h);
+
+// Hand a texture back for reuse (the oldest idle one is destroyed when the
+// pool is full). Its blend mode is reset to SDL_BLENDMODE_NONE.
+void texture_pool_release(TexturePool *pool, SDL_Texture *texture);
+
+// Copy rows y0..y0+rows of src (in the pool's format) into the top-left
+// corner of texture. The edge pixels are repeated into the unused margin
+// so filtering at the image border doesn't pick up stale texels. The
+// texture takes src's blend mode.
+int texture_pool_upload(TexturePool *pool, SDL_Texture *texture,
+                        const SDL_Surface *src, int y0, int rows);
+
+#endif
@@ -31,6 +31,14 @@ void get_unique_key(const char *path, char *out_buffer, size_t size) {
   }
 }
 
+// Add a column to a table created by an older version. Fails harmlessly
+// when the column is there already.
+static void add_column(const char *table, const char *column) {
+  char sql[256];
+  snprintf(sql, sizeof(sql), "ALTER TABLE %s ADD COLUMN %s;", table, column);
+  sqlite3_exec(db, sql, 0, 0, NULL);
+}
+
 int init_bookmarks_db() {
   int rc = sqlite3_open(DB_FILE, &db);
   if (rc) {
@@ -42,7 +50,8 @@ int init_bookmarks_db() {
   const char *sql = "CREATE TABLE IF NOT EXISTS bookmarks ("
                     "path TEXT PRIMARY KEY, "
                     "page INTEGER, "
-                    "last_read TIMESTAMP DEFAULT CURRENT_TIMESTAMP"
+                    "last_read TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
+                    "page_offset REAL DEFAULT 0"
                     ");";
 
   char *err_msg = 0;
@@ -58,7 +67,8 @@ int init_bookmarks_db() {
                      "book_id TEXT PRIMARY KEY, "
                      "page INTEGER, "
                      "completed INTEGER DEFAULT 0, "
-                     "last_synced TIMESTAMP DEFAULT CURRENT_TIMESTAMP"
+                     "last_synced TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
+                     "page_offset REAL DEFAULT 0"
                      ");";
   rc = sqlite3_exec(db, sql2, 0, 0, &err_msg);
   if (rc != SQLITE_OK) {
@@ -67,6 +77,43 @@ int init_bookmarks_db() {
     return -1;
   }
 
+  // Webtoon offset into the page, newer than the tables themselves
+  add_column("bookmarks", "page_offset REAL DEFAULT 0");
+  add_column("komga_progress", "page_offset REAL DEFAULT 0");
+
+  // Page index of each CBZ opened so far and the page sizes of Komga books,
+  // one row per page
+  const char *sql3 = "CREATE TABLE IF NOT EXISTS archives ("
+                     "path TEXT PRIMARY KEY, "
+                     "size INTEGER, "
+                     "mtime INTEGER, "
+                     "pages INTEGER"
+                     ");"
+                     "CREATE TABLE IF NOT EXISTS archive_pages ("
+                     "path TEXT, "
+                     "page INTEGER, "
+                     "entry INTEGER, "
+                     "data_offset INTEGER, "
+                     "comp_size INTEGER, "
+                     "size INTEGER, "
+                     "width INTEGER DEFAULT 0, "
+                     "height INTEGER DEFAULT 0, "
+                     "PRIMARY KEY (path, page)"
+                     ") WITHOUT ROWID;"
+                     "CREATE TABLE IF NOT EXISTS komga_page_sizes ("
+                     "book_id TEXT, "
+                     "page INTEGER, "
+                     "width INTEGER, "
+                     "height INTEGER, "
+                     "PRIMARY KEY (book_id, page)"
+                     ") WITHOUT ROWID;";
+  rc = sqlite3_exec(db, sql3, 0, 0, &err_msg);
+  if (rc != SQLITE_OK) {
+    fprintf(stderr, "SQL error: %s\n", err_msg);
+    sqlite3_free(err_msg);
+    return -1;
+  }
+
   return 0;
 }
 
@@ -75,14 +122,16 @@ void close_bookmarks_db() {
     sqlite3_close(db);
 }
 
-int load_bookmark(const char *filepath) {
+int load_bookmark(const char *filepath, double *out_offset) {
+  if (out_offset)
+    *out_offset = 0;
   if (!db)
     return 0;
 
   char key[MAX_PATH];
   get_unique_key(filepath, key, sizeof(key));
 
-  const char *sql = "SELECT page FROM bookmarks WHERE path = ?;";
+  const char *sql = "SELECT page, page_offset FROM bookmarks WHERE path = ?;";
   sqlite3_stmt *stmt;
 
   int page = 0;
@@ -92,13 +141,15 @@ int load_bookmark(const char *filepath) {
 
     if (sqlite3_step(stmt) == SQLITE_ROW) {
       page = sqlite3_column_int(stmt, 0);
+      if (out_offset)
+        *out_offset = sqlite3_column_double(stmt, 1);
     }
   }
   sqlite3_finalize(stmt);
   return page;
 }
 
-void save_bookmark(const char *filepath, int page_index) {
+void save_bookmark(const char *filepath, int page_index, double offset) {
   if (!db)
     return;
 
@@ -107,13 +158,14 @@ void save_bookmark(const char *filepath, int page_index) {
 
   // INSERT OR REPLACE updates the row if it exists, or creates it if it
   // doesn't.
-  const char *sql = "INSERT OR REPLACE INTO bookmarks (path, page, last_read) "
-                    "VALUES (?, ?, CURRENT_TIMESTAMP);";
+  const char *sql = "INSERT OR REPLACE INTO bookmarks (path, page, last_read, "
+                    "page_offset) VALUES (?, ?, CURRENT_TIMESTAMP, ?);";
   sqlite3_stmt *stmt;
 
   if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK) {
     sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
     sqlite3_bind_int(stmt, 2, page_index);
+    sqlite3_bind_double(stmt, 3, offset);
 
     if (sqlite3_step(stmt) != SQLITE_DONE) {
       fprintf(stderr, "Failed to save bookmark: %s\n", sqlite3_errmsg(db));
@@ -124,31 +176,33 @@ void save_bookmark(const char *filepath, int page_index) {
   sqlite3_finalize(stmt);
 }
 
-void save_komga_progress(const char *book_id, int page, int completed) {
+void save_komga_progress(const char *book_id, int page, int completed,
+                         double offset) {
   if (!db)
     return;
 
   const char *sql =
       "INSERT OR REPLACE INTO komga_progress (book_id, page, completed, "
-      "last_synced) VALUES (?, ?, ?, CURRENT_TIMESTAMP);";
+      "last_synced, page_offset) VALUES (?, ?, ?, CURRENT_TIMESTAMP, ?);";
   sqlite3_stmt *stmt;
 
   if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK) {
     sqlite3_bind_text(stmt, 1, book_id, -1, SQLITE_STATIC);
     sqlite3_bind_int(stmt, 2, page);
     sqlite3_bind_int(stmt, 3, completed);
+    sqlite3_bind_double(stmt, 4, offset);
     sqlite3_step(stmt);
   }
   sqlite3_finalize(stmt);
 }
 
 int load_komga_progress(const char *book_id, int *out_page,
-                        int *out_completed) {
+                        int *out_completed, double *out_offset) {
   if (!db)
     return -1;
 
-  const char *sql =
-      "SELECT page, completed FROM komga_progress WHERE book_id = ?;";
+  const char *sql = "SELECT page, completed, page_offset FROM komga_progress "
+                    "WHERE book_id = ?;";
   sqlite3_stmt *stmt;
   int found = -1;
 
@@ -157,9 +211,191 @@ int load_komga_progress(const char *book_id, int *out_page,
     if (sqlite3_step(stmt) == SQLITE_ROW) {
       *out_page = sqlite3_column_int(stmt, 0);
       *out_completed = sqlite3_column_int(stmt, 1);
+      if (out_offset)
+        *out_offset = sqlite3_column_double(stmt, 2);
       found = 0;
     }
   }
   sqlite3_finalize(stmt);
   return found;
 }
+
+int load_page_index(const char *filepath, long long size, long long mtime,
+                    CbzPage **out_pages, int *out_count) {
+  if (!db)
+    return -1;
+
+  char key[MAX_PATH];
+  get_unique_key(filepath, key, sizeof(key));
+
+  const char *sql =
+      "SELECT pages FROM archives WHERE path = ? AND size = ? AND mtime = ?;";
+  sqlite3_stmt *stmt;
+  int count = 0;
+  if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK) {
+    sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 2, size);
+    sqlite3_bind_int64(stmt, 3, mtime);
+    if (sqlite3_step(stmt) == SQLITE_ROW)
+      count = sqlite3_column_int(stmt, 0);
+  }
+  sqlite3_finalize(stmt);
+  if (count <= 0)
+    return -1;
+
+  CbzPage *pages = calloc(count, sizeof(CbzPage));
+  if (!pages)
+    return -1;
+  const char *sql2 = "SELECT page, entry, data_offset, comp_size, size, "
+                     "width, height FROM archive_pages WHERE path = ?;";
+  int rows = 0;
+  if (sqlite3_prepare_v2(db, sql2, -1, &stmt, 0) == SQLITE_OK) {
+    sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+      int page = sqlite3_column_int(stmt, 0);
+      if (page < 0 || page >= count)
+        continue;
+      CbzPage *p = &pages[page];
+      p->entry = sqlite3_column_int64(stmt, 1);
+      p->offset = sqlite3_column_int64(stmt, 2);
+      p->comp_size = sqlite3_column_int64(stmt, 3);
+      p->size = sqlite3_column_int64(stmt, 4);
+      p->width = sqlite3_column_int(stmt, 5);
+      p->height = sqlite3_column_int(stmt, 6);
+      rows++;
+    }
+  }
+  sqlite3_finalize(stmt);
+
+  if (rows != count) {
+    free(pages);
+    return -1;
+  }
+  *out_pages = pages;
+  *out_count = count;
+  return 0;
+}
+
+void save_page_index(const char *filepath, long long size, long long mtime,
+                     const CbzPage *pages, int count) {
+  if (!db)
+    return;
+
+  char key[MAX_PATH];
+  get_unique_key(filepath, key, sizeof(key));
+
+  // One transaction, so thousands of pages cost a single sync
+  sqlite3_exec(db, "BEGIN;", 0, 0, 0);
+  sqlite3_stmt *stmt;
+  int ok = 1;
+  if (sqlite3_prepare_v2(db, "DELETE FROM archive_pages WHERE path = ?;", -1,
+                         &stmt, 0) == SQLITE_OK) {
+    sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
+    ok = sqlite3_step(stmt) == SQLITE_DONE;
+  }
+  sqlite3_finalize(stmt);
+
+  const char *sql = "INSERT INTO archive_pages (path, page, entry, "
+                    "data_offset, comp_size, size, width, height) "
+                    "VALUES (?, ?, ?, ?, ?, ?, ?, ?);";
+  if (ok && sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK) {
+    for (int i = 0; i < count && ok; i++) {
+      sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
+      sqlite3_bind_int(stmt, 2, i);
+      sqlite3_bind_int64(stmt, 3, pages[i].entry);
+      sqlite3_bind_int64(stmt, 4, pages[i].offset);
+      sqlite3_bind_int64(stmt, 5, pages[i].comp_size);
+      sqlite3_bind_int64(stmt, 6, pages[i].size);
+      sqlite3_bind_int(stmt, 7, pages[i].width);
+      sqlite3_bind_int(stmt, 8, pages[i].height);
+      ok = sqlite3_step(stmt) == SQLITE_DONE;
+      sqlite3_reset(stmt);
+    }
+  } else {
+    ok = 0;
+  }
+  sqlite3_finalize(stmt);
+
+  const char *sql2 = "INSERT OR REPLACE INTO archives (path, size, mtime, "
+                     "pages) VALUES (?, ?, ?, ?);";
+  if (ok && sqlite3_prepare_v2(db, sql2, -1, &stmt, 0) == SQLITE_OK) {
+    sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 2, size);
+    sqlite3_bind_int64(stmt, 3, mtime);
+    sqlite3_bind_int(stmt, 4, count);
+    ok = sqlite3_step(stmt) == SQLITE_DONE;
+  } else {
+    ok = 0;
+  }
+  sqlite3_finalize(stmt);
+
+  if (!ok)
+    fprintf(stderr, "Failed to save page index: %s\n", sqlite3_errmsg(db));
+  sqlite3_exec(db, ok ? "COMMIT;" : "ROLLBACK;", 0, 0, 0);
+}
+
+// Write (key, page, width, height) rows with sql in one transaction
+static void save_sizes(const char *sql, const char *key, const PageSize *sizes,
+                       int count) {
+  sqlite3_stmt *stmt;
+  if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK) {
+    fprintf(stderr, "Failed to save page sizes: %s\n", sqlite3_errmsg(db));
+    return;
+  }
+  sqlite3_exec(db, "BEGIN;", 0, 0, 0);
+  for (int i = 0; i < count; i++) {
+    if (sizes[i].w <= 0)
+      continue;
+    sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, i);
+    sqlite3_bind_int(stmt, 3, sizes[i].w);
+    sqlite3_bind_int(stmt, 4, sizes[i].h);
+    sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+  }
+  sqlite3_exec(db, "COMMIT;", 0, 0, 0);
+  sqlite3_finalize(stmt);
+}
+
+void save_page_sizes(const char *filepath, const PageSize *sizes, int count) {
+  if (!db)
+    return;
+
+  char key[MAX_PATH];
+  get_unique_key(filepath, key, sizeof(key));
+  save_sizes("UPDATE archive_pages SET width = ?3, height = ?4 "
+             "WHERE path = ?1 AND page = ?2;",
+             key, sizes, count);
+}
+
+int load_komga_page_sizes(const char *book_id, PageSize *sizes, int count) {
+  if (!db)
+    return 0;
+
+  const char *sql = "SELECT page, width, height FROM komga_page_sizes "
+                    "WHERE book_id = ?;";
+  sqlite3_stmt *stmt;
+  int found = 0;
+  if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK) {
+    sqlite3_bind_text(stmt, 1, book_id, -1, SQLITE_STATIC);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+      int page = sqlite3_column_int(stmt, 0);
+      if (page < 0 || page >= count)
+        continue;
+      sizes[page].w = sqlite3_column_int(stmt, 1);
+      sizes[page].h = sqlite3_column_int(stmt, 2);
+      found++;
+    }
+  }
+  sqlite3_finalize(stmt);
+  return found;
+}
+
+void save_komga_page_sizes(const char *book_id, const PageSize *sizes,
+                           int count) {
+  if (!db)
+    return;
+  save_sizes("INSERT OR REPLACE INTO komga_page_sizes (book_id, page, width, "
+             "height) VALUES (?, ?, ?, ?);",
+             book_id, sizes, count);
+}
@@ -1,5 +1,4 @@
 #include "browser_ui.h"
-#include <SDL2/SDL_image.h>
 #include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -39,24 +38,47 @@ static ReadMode detect_mode_from_library(const char *name) {
   return MODE_MANGA;
 }
 
-static SDL_Texture *load_texture_from_bytes(SDL_Renderer *renderer, char *data,
-                                            size_t size, int *out_w,
-                                            int *out_h) {
-  if (!data || size == 0)
-    return NULL;
-
-  SDL_RWops *rw = SDL_RWFromMem(data, size);
-  SDL_Surface *surf = IMG_Load_RW(rw, 1);
-  if (!surf)
-    return NULL;
-
-  SDL_Texture *tex = SDL_CreateTextureFromSurface(renderer, surf);
-  if (out_w)
-    *out_w = surf->w;
-  if (out_h)
-    *out_h = surf->h;
-  SDL_FreeSurface(surf);
-  return tex;
+// Decode pool callbacks: keep the pixels if the grid wasn't reloaded
+// since; render_cover_grid() uploads them within the frame budget. Return
+// 1 when the surface was kept.
+static int store_cover(CoverImage *covers, int count, int index,
+                       SDL_Surface *surface) {
+  if (!covers || index < 0 || index >= count || !surface ||
+      covers[index].texture || covers[index].pixels)
+    return 0;
+  covers[index].pixels = surface;
+  covers[index].width = surface->w;
+  covers[index].height = surface->h;
+  return 1;
+}
+
+static int series_cover_decoded(SDL_Renderer *renderer, void *user,
+                                int index, unsigned gen,
+                                SDL_Surface *surface) {
+  BrowserState *state = (BrowserState *)user;
+  if (gen != state->series_cover_gen)
+    return 0;
+  return store_cover(state->series_covers, state->series_count, index,
+                     surface);
+}
+
+static int book_cover_decoded(SDL_Renderer *renderer, void *user, int index,
+                              unsigned gen, SDL_Surface *surface) {
+  BrowserState *state = (BrowserState *)user;
+  if (gen != state->book_cover_gen)
+    return 0;
+  return store_cover(state->book_covers, state->books_count, index, surface);
+}
+
+// Create a cover's texture if it is decoded and the frame has budget left
+static void upload_cover(AppContext *app, CoverImage *cover) {
+  SDL_Surface *s = cover->pixels;
+  if (cover->texture || !s ||
+      !upload_budget_take(app, (size_t)s->pitch * s->h))
+    return;
+  cover->texture = SDL_CreateTextureFromSurface(app->renderer, s);
+  SDL_FreeSurface(s);
+  cover->pixels = NULL;
 }
 
 static void free_covers(CoverImage *covers, int count,
@@ -66,45 +88,21 @@ static void free_covers(CoverImage *covers, int count,
   for (int i = 0; i < count; i++) {
     if (covers[i].texture)
       SDL_DestroyTexture(covers[i].texture);
+    if (covers[i].pixels)
+      SDL_FreeSurface(covers[i].pixels);
   }
   free(covers);
 }
 
 static void draw_text(AppContext *app, const char *text, int x, int y,
                       SDL_Color color) {
-  if (!app->font || !text || !text[0])
-    return;
-  int w, h;
-  SDL_Texture *tex =
-      render_text_texture(app->renderer, app->font, text, color, &w, &h);
-  if (tex) {
-    SDL_Rect dest = {x, y, w, h};
-    SDL_RenderCopy(app->renderer, tex, NULL, &dest);
-    SDL_DestroyTexture(tex);
-  }
+  text_cache_draw(&app->text, text, color, x, y, 0);
 }
 
+// Truncated with an ellipsis to max_w; the fitting is cached with the text
 static void draw_text_truncated(AppContext *app, const char *text, int x, int y,
                                 int max_w, SDL_Color color) {
-  if (!app->font || !text || !text[0])
-    return;
-
-  char buf[256];
-  strncpy(buf, text, 255);
-  buf[255] = '\0';
-
-  // Truncate with ellipsis if needed
-  int w, h;
-  TTF_SizeText(app->font, buf, &w, &h);
-  while (w > max_w && strlen(buf) > 4) {
-    buf[strlen(buf) - 4] = '.';
-    buf[strlen(buf) - 3] = '.';
-    buf[strlen(buf) - 2] = '.';
-    buf[strlen(buf) - 1] = '\0';
-    TTF_SizeText(app->font, buf, &w, &h);
-  }
-
-  draw_text(app, buf, x, y, color);
+  text_cache_draw(&app->text, text, color, x, y, max_w);
 }
 
 // --- Lifecycle ---
@@ -115,7 +113,9 @@ void browser_init(BrowserState *state) {
   state->grid_cols = 4;
 }
 
-void browser_cleanup(BrowserState *state, SDL_Renderer *renderer) {
+void browser_cleanup(BrowserState *state, AppContext *app) {
+  SDL_Renderer *renderer = app->renderer;
+  decode_pool_cancel(&app->decode_pool, state);
   if (state->series_covers)
     free_covers(state->series_covers, state->series_count, renderer);
   if (state->book_covers)
@@ -145,10 +145,11 @@ int browser_load_libraries(BrowserState *state, KomgaClient *client) {
 }
 
 int browser_load_series(BrowserState *state, KomgaClient *client,
-                        SDL_Renderer *renderer, int page) {
+                        AppContext *app, int page) {
   // Free previous series data
+  state->series_cover_gen++;
   if (state->series_covers) {
-    free_covers(state->series_covers, state->series_count, renderer);
+    free_covers(state->series_covers, state->series_count, app->renderer);
     state->series_covers = NULL;
   }
   if (state->series_list) {
@@ -176,22 +177,24 @@ int browser_load_series(BrowserState *state, KomgaClient *client,
     size_t size;
     char *data =
         komga_get_series_thumbnail(client, state->series_list[i].id, &size);
-    if (data) {
-      state->series_covers[i].texture = load_texture_from_bytes(
-          renderer, data, size, &state->series_covers[i].width,
-          &state->series_covers[i].height);
+    if (data && size > 0)
+      decode_pool_submit(&app->decode_pool, page_buffer_wrap(data, size),
+                         COVER_WIDTH, (int)(COVER_WIDTH * 1.4f),
+                         series_cover_decoded, state, i,
+                         state->series_cover_gen);
+    else
       free(data);
-    }
   }
 
   return 0;
 }
 
 int browser_load_books(BrowserState *state, KomgaClient *client,
-                       SDL_Renderer *renderer, int page) {
+                       AppContext *app, int page) {
   // Free previous book data
+  state->book_cover_gen++;
   if (state->book_covers) {
-    free_covers(state->book_covers, state->books_count, renderer);
+    free_covers(state->book_covers, state->books_count, app->renderer);
     state->book_covers = NULL;
   }
   if (state->books_list) {
@@ -227,12 +230,12 @@ int browser_load_books(BrowserState *state, KomgaClient *client,
     size_t size;
     char *data =
         komga_get_book_thumbnail(client, state->books_list[i].id, &size);
-    if (data) {
-      state->book_covers[i].texture = load_texture_from_bytes(
-          renderer, data, size, &state->book_covers[i].width,
-          &state->book_covers[i].height);
+    if (data && size > 0)
+      decode_pool_submit(&app->decode_pool, page_buffer_wrap(data, size),
+                         COVER_WIDTH, (int)(COVER_WIDTH * 1.4f),
+                         book_cover_decoded, state, i, state->book_cover_gen);
+    else
       free(data);
-    }
   }
 
   return 0;
@@ -308,6 +311,7 @@ static void render_cover_grid(AppContext *app, CoverImage *covers,
 
   int start_x = (win_w - grid_cols * cell_w) / 2 + COVER_PADDING / 2;
 
+  int first = -1, last = -1; // visible cells
   for (int i = 0; i < count; i++) {
     int col = i % grid_cols;
     int row = i / grid_cols;
@@ -318,6 +322,9 @@ static void render_cover_grid(AppContext *app, CoverImage *covers,
     // Skip if off-screen
     if (y + cell_h < y_offset || y > win_h)
       continue;
+    if (first < 0)
+      first = i;
+    last = i;
 
     // Selection highlight
     if (i == selected) {
@@ -334,6 +341,8 @@ static void render_cover_grid(AppContext *app, CoverImage *covers,
 
     // Cover image or placeholder
     int cover_h = (int)(COVER_WIDTH * 1.4f);
+    if (covers)
+      upload_cover(app, &covers[i]);
     if (covers && covers[i].texture) {
       // Maintain aspect ratio within the cell
       float ar = (float)covers[i].width / covers[i].height;
@@ -360,6 +369,17 @@ static void render_cover_grid(AppContext *app, CoverImage *covers,
       draw_text_truncated(app, names[i], x, y + cover_h + 5, COVER_WIDTH,
                           COLOR_WHITE);
   }
+
+  // Then the covers around the viewport, nearest first, so scrolling finds
+  // them ready
+  if (!covers || first < 0)
+    return;
+  for (int d = 1; last + d < count || first - d >= 0; d++) {
+    if (last + d < count)
+      upload_cover(app, &covers[last + d]);
+    if (first - d >= 0)
+      upload_cover(app, &covers[first - d]);
+  }
 }
 
 static void render_footer(BrowserState *state, AppContext *app, int win_w,
@@ -386,14 +406,14 @@ static void render_footer(BrowserState *state, AppContext *app, int win_w,
                          ? "Enter:Open  Tab:Library  PgUp/Dn:Page  ESC:Quit"
                          : "Enter:Read  D:Download  Bksp:Back  PgUp/Dn:Page";
   int tw, th;
-  if (app->font) {
-    TTF_SizeText(app->font, keys, &tw, &th);
+  if (text_cache_get(&app->text, keys, COLOR_GRAY, 0, &tw, &th))
     draw_text(app, keys, win_w - tw - 15, win_h - FOOTER_HEIGHT + 8,
               COLOR_GRAY);
-  }
 }
 
 void browser_render(BrowserState *state, AppContext *app) {
+  app->dirty = 0;
+  upload_budget_reset(app);
   SDL_SetRenderDrawColor(app->renderer, COLOR_BG.r, COLOR_BG.g, COLOR_BG.b,
                          255);
   SDL_RenderClear(app->renderer);
@@ -549,7 +569,7 @@ BrowserResult browser_handle_event(BrowserState *state, SDL_Event *event,
           tab_idx != state->selected_library) {
         state->selected_library = tab_idx;
         state->current_view = BROWSER_SERIES;
-        browser_load_series(state, client, app->renderer, 0);
+        browser_load_series(state, client, app, 0);
       }
       return result;
     }
@@ -561,7 +581,7 @@ BrowserResult browser_handle_event(BrowserState *state, SDL_Event *event,
 
       if (state->current_view == BROWSER_SERIES) {
         // Enter series
-        browser_load_books(state, client, app->renderer, 0);
+        browser_load_books(state, client, app, 0);
         state->current_view = BROWSER_BOOKS;
       } else {
         // Open book
@@ -606,7 +626,7 @@ BrowserResult browser_handle_event(BrowserState *state, SDL_Event *event,
   case SDLK_RETURN:
     if (count > 0) {
       if (state->current_view == BROWSER_SERIES) {
-        browser_load_books(state, client, app->renderer, 0);
+        browser_load_books(state, client, app, 0);
         state->current_view = BROWSER_BOOKS;
       } else {
         result.action = BROWSER_ACTION_OPEN_BOOK;
@@ -655,7 +675,7 @@ BrowserResult browser_handle_event(BrowserState *state, SDL_Event *event,
     if (next != state->selected_library) {
       state->selected_library = next;
       state->current_view = BROWSER_SERIES;
-      browser_load_series(state, client, app->renderer, 0);
+      browser_load_series(state, client, app, 0);
     }
     break;
   }
@@ -668,7 +688,7 @@ BrowserResult browser_handle_event(BrowserState *state, SDL_Event *event,
     if (idx < state->library_count && idx != state->selected_library) {
       state->selected_library = idx;
       state->current_view = BROWSER_SERIES;
-      browser_load_series(state, client, app->renderer, 0);
+      browser_load_series(state, client, app, 0);
     }
     break;
   }
@@ -682,9 +702,9 @@ BrowserResult browser_handle_event(BrowserState *state, SDL_Event *event,
                     : state->books_total_pages;
     if (cur_page + 1 < total) {
       if (state->current_view == BROWSER_SERIES)
-        browser_load_series(state, client, app->renderer, cur_page + 1);
+        browser_load_series(state, client, app, cur_page + 1);
       else
-        browser_load_books(state, client, app->renderer, cur_page + 1);
+        browser_load_books(state, client, app, cur_page + 1);
     }
     break;
   }
@@ -695,9 +715,9 @@ BrowserResult browser_handle_event(BrowserState *state, SDL_Event *event,
                        : state->books_current_page;
     if (cur_page > 0) {
       if (state->current_view == BROWSER_SERIES)
-        browser_load_series(state, client, app->renderer, cur_page - 1);
+        browser_load_series(state, client, app, cur_page - 1);
       else
-        browser_load_books(state, client, app->renderer, cur_page - 1);
+        browser_load_books(state, client, app, cur_page - 1);
     }
     break;
   }
@@ -1,8 +1,20 @@
 #include "cbz_handler.h"
+#include "bookmark_manager.h"
 #include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#define ZIP_EOCD_SIG 0x06054b50u   // end of central directory
+#define ZIP_CENTRAL_SIG 0x02014b50u // central directory entry
+#define ZIP_LOCAL_SIG 0x04034b50u   // local file header
 
 // Helper: Case-insensitive string comparison for extensions
 static int str_ends_with_ignore_case(const char *str, const char *suffix) {
@@ -31,88 +43,365 @@ static int is_image_file(const char *filename) {
          str_ends_with_ignore_case(filename, ".jpeg");
 }
 
-// Helper: Comparator for qsort
-static int compare_strings(const void *a, const void *b) {
-  return strcmp(*(const char **)a, *(const char **)b);
+// Helper: Skip __MACOSX folders and hidden files often found in zips
+static int is_page_entry(const char *name) {
+  return name[0] != '.' && strstr(name, "__MACOSX") == 0 &&
+         is_image_file(name);
 }
 
-int open_cbz(const char *path, MangaBook *book) {
-  int err = 0;
-  book->archive = zip_open(path, 0, &err);
-  if (!book->archive)
-    return err;
-
-  book->current_index = 0;
-  book->count = 0;
-
-  // Count valid images
-  int num_entries = zip_get_num_entries(book->archive, 0);
-  for (int i = 0; i < num_entries; i++) {
-    const char *name = zip_get_name(book->archive, i, 0);
-    // Ignore __MACOSX folders and hidden files often found in zips
-    if (name[0] != '.' && strstr(name, "__MACOSX") == 0 &&
-        is_image_file(name)) {
-      book->count++;
+// An archive entry that is a page, while the index is being built
+typedef struct {
+  char *name;
+  CbzPage page;
+} ScanEntry;
+
+// Helper: Comparator for qsort (alphabetical is manga page order)
+static int compare_entries(const void *a, const void *b) {
+  return strcmp(((const ScanEntry *)a)->name, ((const ScanEntry *)b)->name);
+}
+
+static int add_entry(ScanEntry **entries, int *count, int *cap,
+                     const char *name, size_t name_len, CbzPage page) {
+  if (*count == *cap) {
+    int new_cap = *cap ? *cap * 2 : 64;
+    ScanEntry *grown = realloc(*entries, new_cap * sizeof(ScanEntry));
+    if (!grown)
+      return -1;
+    *entries = grown;
+    *cap = new_cap;
+  }
+  char *copy = malloc(name_len + 1);
+  if (!copy)
+    return -1;
+  memcpy(copy, name, name_len);
+  copy[name_len] = '\0';
+  (*entries)[*count].name = copy;
+  (*entries)[*count].page = page;
+  (*count)++;
+  return 0;
+}
+
+static void free_entries(ScanEntry *entries, int count) {
+  for (int i = 0; i < count; i++)
+    free(entries[i].name);
+  free(entries);
+}
+
+// --- Archive mapping ---
+
+static unsigned rd16(const unsigned char *p) { return p[0] | p[1] << 8; }
+
+static unsigned long rd32(const unsigned char *p) {
+  return (unsigned long)p[0] | (unsigned long)p[1] << 8 |
+         (unsigned long)p[2] << 16 | (unsigned long)p[3] << 24;
+}
+
+static void map_release(void *owner) {
+  CbzMapping *map = (CbzMapping *)owner;
+  if (atomic_fetch_sub_explicit(&map->refs, 1, memory_order_acq_rel) != 1)
+    return;
+#ifndef _WIN32
+  munmap((void *)map->base, map->size);
+#endif
+  free(map);
+}
+
+// Map the archive read-only so stored pages can be handed out in place. A
+// book that can't be mapped reads every page through libzip.
+static void map_archive(MangaBook *book, size_t size) {
+#ifndef _WIN32
+  if (size == 0)
+    return;
+  int fd = open(book->path, O_RDONLY);
+  if (fd < 0)
+    return;
+  void *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED)
+    return;
+  book->map = malloc(sizeof(CbzMapping));
+  if (!book->map) {
+    munmap(base, size);
+    return;
+  }
+  atomic_init(&book->map->refs, 1);
+  book->map->base = base;
+  book->map->size = size;
+#else
+  (void)book;
+  (void)size;
+#endif
+}
+
+// --- Building the page index ---
+
+// Collect the pages straight from the central directory in the mapping,
+// along with where stored pages' bytes start past their local headers.
+// Fails on anything unusual (no directory found, ZIP64) so libzip can
+// deal with it instead.
+static int scan_mapped(MangaBook *book, ScanEntry **entries, int *count) {
+  const unsigned char *base = (const unsigned char *)book->map->base;
+  size_t size = book->map->size;
+  if (size < 22)
+    return -1;
+
+  // End of central directory, behind a comment of up to 64 KB
+  size_t eocd = size - 22, stop = size > 22 + 65535 ? size - 22 - 65535 : 0;
+  while (rd32(base + eocd) != ZIP_EOCD_SIG) {
+    if (eocd == stop)
+      return -1;
+    eocd--;
+  }
+  unsigned total = rd16(base + eocd + 10);
+  size_t pos = rd32(base + eocd + 16);
+  if (total == 0xFFFF || pos == 0xFFFFFFFFul)
+    return -1;
+
+  int cap = 0;
+  for (unsigned i = 0; i < total; i++) {
+    if (pos + 46 > size || rd32(base + pos) != ZIP_CENTRAL_SIG)
+      return -1;
+    const unsigned char *cd = base + pos;
+    unsigned flags = rd16(cd + 8), method = rd16(cd + 10);
+    unsigned long comp = rd32(cd + 20), plain = rd32(cd + 24);
+    unsigned name_len = rd16(cd + 28);
+    size_t local = rd32(cd + 42);
+    pos += 46 + name_len + rd16(cd + 30) + rd16(cd + 32);
+    if (pos > size || comp == 0xFFFFFFFFul || plain == 0xFFFFFFFFul ||
+        local == 0xFFFFFFFFul)
+      return -1;
+
+    const char *name = (const char *)cd + 46;
+    if (name_len == 0)
+      continue;
+    char check[1024];
+    size_t n = name_len < sizeof(check) - 1 ? name_len : sizeof(check) - 1;
+    memcpy(check, name, n);
+    check[n] = '\0';
+    if (!is_page_entry(check))
+      continue;
+
+    CbzPage page = {i, 0, comp, plain, 0, 0};
+    // Pages libzip would have to inflate or decrypt keep no offset
+    if (method == ZIP_CM_STORE && !(flags & 1) && comp == plain &&
+        local + 30 <= size && rd32(base + local) == ZIP_LOCAL_SIG) {
+      size_t data =
+          local + 30 + rd16(base + local + 26) + rd16(base + local + 28);
+      if (data + plain <= size)
+        page.offset = data;
     }
+    if (add_entry(entries, count, &cap, name, name_len, page) != 0)
+      return -1;
   }
+  return 0;
+}
+
+// A libzip handle on the book's file for this thread alone: an idle one
+// from the pool, or a newly opened one. NULL if the file can't be opened.
+static zip_t *acquire_handle(MangaBook *book) {
+  CbzHandlePool *pool = &book->handles;
+  zip_t *archive = NULL;
+  pthread_mutex_lock(&pool->lock);
+  if (pool->idle_count > 0)
+    archive = pool->idle[--pool->idle_count];
+  pthread_mutex_unlock(&pool->lock);
+  if (!archive) {
+    int err = 0;
+    archive = zip_open(book->path, ZIP_RDONLY, &err);
+  }
+  return archive;
+}
 
-  if (book->count == 0)
+static void release_handle(MangaBook *book, zip_t *archive) {
+  if (!archive)
+    return;
+  CbzHandlePool *pool = &book->handles;
+  pthread_mutex_lock(&pool->lock);
+  if (pool->idle_count < CBZ_HANDLE_POOL) {
+    pool->idle[pool->idle_count++] = archive;
+    archive = NULL;
+  }
+  pthread_mutex_unlock(&pool->lock);
+  if (archive)
+    zip_close(archive);
+}
+
+// Same through libzip, for archives that can't be mapped or parsed here
+static int scan_libzip(MangaBook *book, ScanEntry **entries, int *count) {
+  zip_t *archive = acquire_handle(book);
+  if (!archive)
     return -1;
 
-  // Allocate filename array
-  book->filenames = malloc(sizeof(char *) * book->count);
-  int head = 0;
-  for (int i = 0; i < num_entries; i++) {
-    const char *name = zip_get_name(book->archive, i, 0);
-    if (name[0] != '.' && strstr(name, "__MACOSX") == 0 &&
-        is_image_file(name)) {
-      book->filenames[head++] = strdup(name);
+  int cap = 0, rc = 0;
+  zip_int64_t total = zip_get_num_entries(archive, 0);
+  for (zip_int64_t i = 0; i < total && rc == 0; i++) {
+    struct zip_stat st;
+    if (zip_stat_index(archive, i, 0, &st) != 0 || !st.name ||
+        !is_page_entry(st.name))
+      continue;
+    CbzPage page = {i, 0, st.comp_size, st.size, 0, 0};
+    rc = add_entry(entries, count, &cap, st.name, strlen(st.name), page);
+  }
+  release_handle(book, archive); // kept for the pages it will read
+  return rc;
+}
+
+// Read up to size bytes of an entry into buf through a pooled handle.
+// Returns the bytes read, -1 on failure.
+static zip_int64_t extract(MangaBook *book, const CbzPage *page, void *buf,
+                           size_t size) {
+  zip_t *archive = acquire_handle(book);
+  zip_file_t *f = archive ? zip_fopen_index(archive, page->entry, 0) : NULL;
+  zip_int64_t got = f ? zip_fread(f, buf, size) : -1;
+  if (f)
+    zip_fclose(f);
+  release_handle(book, archive);
+  return got;
+}
+
+// Walk the archive once and sort its pages
+static int build_index(MangaBook *book) {
+  ScanEntry *entries = NULL;
+  int count = 0;
+  if (!book->map || scan_mapped(book, &entries, &count) != 0) {
+    free_entries(entries, count);
+    entries = NULL;
+    count = 0;
+    if (scan_libzip(book, &entries, &count) != 0) {
+      free_entries(entries, count);
+      return -1;
     }
   }
+  if (count == 0) {
+    free(entries);
+    return -1;
+  }
+
+  qsort(entries, count, sizeof(ScanEntry), compare_entries);
+  book->pages = malloc(count * sizeof(CbzPage));
+  if (!book->pages) {
+    free_entries(entries, count);
+    return -1;
+  }
+  for (int i = 0; i < count; i++)
+    book->pages[i] = entries[i].page;
+  book->count = count;
+  free_entries(entries, count);
+  return 0;
+}
+
+// Offset of page index in the mapping, 0 if it has to go through libzip
+static size_t mapped_offset(const MangaBook *book, int index) {
+  const CbzPage *page = &book->pages[index];
+  if (!book->map || page->offset == 0 ||
+      page->offset + page->size > book->map->size)
+    return 0;
+  return page->offset;
+}
+
+// --- Public API ---
 
-  // Sort alphabetically (Essential for manga page order)
-  qsort(book->filenames, book->count, sizeof(char *), compare_strings);
+int open_cbz(const char *path, MangaBook *book) {
+  memset(book, 0, sizeof(MangaBook));
+  strncpy(book->path, path, sizeof(book->path) - 1);
+  pthread_mutex_init(&book->handles.lock, NULL);
 
+  struct stat st;
+  if (stat(path, &st) != 0) {
+    close_cbz(book);
+    return -1;
+  }
+  map_archive(book, st.st_size);
+
+  // A known archive skips its central directory altogether
+  if (load_page_index(path, st.st_size, st.st_mtime, &book->pages,
+                      &book->count) != 0) {
+    if (build_index(book) != 0) {
+      close_cbz(book);
+      return -1;
+    }
+    save_page_index(path, st.st_size, st.st_mtime, book->pages, book->count);
+  }
   return 0;
 }
 
 void close_cbz(MangaBook *book) {
-  if (book->archive)
-    zip_close(book->archive);
-  if (book->filenames) {
-    for (int i = 0; i < book->count; i++)
-      free(book->filenames[i]);
-    free(book->filenames);
-  }
+  // Every thread reading the book is done by now, so all handles are idle
+  for (int i = 0; i < book->handles.idle_count; i++)
+    zip_close(book->handles.idle[i]);
+  book->handles.idle_count = 0;
+  pthread_mutex_destroy(&book->handles.lock);
+  if (book->map)
+    map_release(book->map); // pages still borrowed keep it mapped
+  free(book->pages);
+  book->map = NULL;
+  book->pages = NULL;
 }
 
-char *get_image_data(MangaBook *book, size_t *out_size) {
-  if (book->current_index < 0 || book->current_index >= book->count)
+char *read_page_data(MangaBook *book, int index, size_t *out_size) {
+  if (index < 0 || index >= book->count)
     return NULL;
 
-  const char *fname = book->filenames[book->current_index];
-  struct zip_stat st;
-  zip_stat_init(&st);
-  zip_stat(book->archive, fname, 0, &st);
-
-  char *contents = malloc(st.size);
+  const CbzPage *page = &book->pages[index];
+  char *contents = malloc(page->size ? page->size : 1);
   if (!contents)
     return NULL;
 
-  zip_file_t *f = zip_fopen(book->archive, fname, 0);
-  if (!f) {
+  size_t offset = mapped_offset(book, index);
+  if (offset) {
+    memcpy(contents, book->map->base + offset, page->size);
+  } else if (extract(book, page, contents, page->size) !=
+             (zip_int64_t)page->size) {
     free(contents);
     return NULL;
   }
 
-  zip_fread(f, contents, st.size);
-  zip_fclose(f);
-
   if (out_size)
-    *out_size = st.size;
+    *out_size = page->size;
   return contents;
 }
 
+PageBuffer *borrow_page_data(MangaBook *book, int index) {
+  if (index < 0 || index >= book->count)
+    return NULL;
+  size_t offset = mapped_offset(book, index);
+  if (offset) {
+    atomic_fetch_add_explicit(&book->map->refs, 1, memory_order_relaxed);
+    return page_buffer_borrow(book->map->base + offset,
+                              book->pages[index].size, map_release, book->map);
+  }
+
+  size_t size = 0;
+  char *data = read_page_data(book, index, &size);
+  if (!data || size == 0) {
+    free(data);
+    return NULL;
+  }
+  return page_buffer_wrap(data, size);
+}
+
+int probe_page_size(MangaBook *book, int index, PageSize *out) {
+  if (index < 0 || index >= book->count)
+    return -1;
+  size_t offset = mapped_offset(book, index);
+  if (offset)
+    return probe_image_size((const unsigned char *)book->map->base + offset,
+                            book->pages[index].size, out);
+
+  // Deflated: inflate just the head, which nearly always holds the size
+  const CbzPage *page = &book->pages[index];
+  size_t want = page->size < PROBE_HEAD_BYTES ? page->size : PROBE_HEAD_BYTES;
+  unsigned char *head = malloc(want ? want : 1);
+  zip_int64_t got = head ? extract(book, page, head, want) : -1;
+  int rc = got > 0 ? probe_image_size(head, (size_t)got, out) : -1;
+  free(head);
+  return rc;
+}
+
+char *get_image_data(MangaBook *book, size_t *out_size) {
+  return read_page_data(book, book->current_index, out_size);
+}
+
 void next_page(MangaBook *book) {
   if (book->current_index < book->count - 1)
     book->current_index++;
@@ -21,6 +21,10 @@ static void trim(char *s) {
 void config_set_defaults(AppConfig *cfg) {
   memset(cfg, 0, sizeof(AppConfig));
   strncpy(cfg->download_path, "./downloads", sizeof(cfg->download_path) - 1);
+  cfg->cache_budget_mb = 256;
+  cfg->prefetch_connections = 4;
+  cfg->strip_margin = 100;
+  cfg->upload_budget_mb = 16;
 }
 
 int config_load(AppConfig *cfg) {
@@ -75,9 +79,19 @@ int config_load(AppConfig *cfg) {
         strncpy(cfg->komga_username, val, sizeof(cfg->komga_username) - 1);
       else if (strcmp(key, "password") == 0)
         strncpy(cfg->komga_password, val, sizeof(cfg->komga_password) - 1);
+      else if (strcmp(key, "prefetch_connections") == 0 && atoi(val) > 0)
+        cfg->prefetch_connections = atoi(val);
     } else if (strcmp(section, "downloads") == 0) {
       if (strcmp(key, "path") == 0)
         strncpy(cfg->download_path, val, sizeof(cfg->download_path) - 1);
+    } else if (strcmp(section, "cache") == 0) {
+      if (strcmp(key, "budget_mb") == 0 && atoi(val) > 0)
+        cfg->cache_budget_mb = atoi(val);
+    } else if (strcmp(section, "reader") == 0) {
+      if (strcmp(key, "strip_margin") == 0 && atoi(val) >= 0)
+        cfg->strip_margin = atoi(val);
+      else if (strcmp(key, "upload_budget_mb") == 0 && atoi(val) >= 0)
+        cfg->upload_budget_mb = atoi(val);
     }
   }
 
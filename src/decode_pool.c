@@ -0,0 +1,245 @@
+#include "decode_pool.h"
+#include "render_engine.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- Internal helpers (caller holds pool->lock) ---
+
+static void push_job(DecodeJob **head, DecodeJob **tail, DecodeJob *job) {
+  job->next = NULL;
+  if (*tail)
+    (*tail)->next = job;
+  else
+    *head = job;
+  *tail = job;
+}
+
+static DecodeJob *pop_job(DecodeJob **head, DecodeJob **tail) {
+  DecodeJob *job = *head;
+  if (job) {
+    *head = job->next;
+    if (!*head)
+      *tail = NULL;
+  }
+  return job;
+}
+
+static void free_job(DecodeJob *job) {
+  page_buffer_release(job->buf);
+  if (job->surface)
+    SDL_FreeSurface(job->surface);
+  free(job);
+}
+
+// Whether job belongs to user and, unless all is set, is the one submitted
+// with key and gen
+static int job_matches(const DecodeJob *job, void *user, int all, int key,
+                       unsigned gen) {
+  return job->user == user && (all || (job->key == key && job->gen == gen));
+}
+
+// Unlink and free every matching job in the list
+static void drop_jobs(DecodeJob **head, DecodeJob **tail, void *user, int all,
+                      int key, unsigned gen) {
+  DecodeJob *prev = NULL;
+  DecodeJob *job = *head;
+  while (job) {
+    DecodeJob *next = job->next;
+    if (job_matches(job, user, all, key, gen)) {
+      if (prev)
+        prev->next = next;
+      else
+        *head = next;
+      if (*tail == job)
+        *tail = prev;
+      free_job(job);
+    } else {
+      prev = job;
+    }
+    job = next;
+  }
+}
+
+static void *decode_worker(void *arg) {
+  DecodePool *pool = (DecodePool *)arg;
+
+  pthread_mutex_lock(&pool->lock);
+  int slot = pool->workers_started++; // this thread's active[] entry
+
+  while (pool->running) {
+    DecodeJob *job = pop_job(&pool->pending_head, &pool->pending_tail);
+    if (!job) {
+      pthread_cond_wait(&pool->work_cond, &pool->lock);
+      continue;
+    }
+    pool->active[slot] = job;
+    pthread_mutex_unlock(&pool->lock);
+
+    job->surface =
+        decode_page(job->buf->data, job->buf->size, job->max_w, job->max_h);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->active[slot] = NULL;
+    page_buffer_release(job->buf);
+    job->buf = NULL;
+    if (job->cancelled) {
+      free_job(job);
+    } else {
+      push_job(&pool->done_head, &pool->done_tail, job);
+      decode_pool_wake(pool);
+    }
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+
+// --- Public API ---
+
+int decode_pool_init(DecodePool *pool, SDL_Renderer *renderer, int threads) {
+  memset(pool, 0, sizeof(DecodePool));
+  pool->renderer = renderer;
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->work_cond, NULL);
+  pool->wake_event = SDL_RegisterEvents(1);
+  atomic_init(&pool->wake_pending, 0);
+
+  if (threads <= 0)
+    threads = SDL_GetCPUCount();
+  if (threads < 1)
+    threads = 1;
+  if (threads > DECODE_POOL_MAX_THREADS)
+    threads = DECODE_POOL_MAX_THREADS;
+
+  pool->running = 1;
+  for (int i = 0; i < threads; i++) {
+    if (pthread_create(&pool->threads[i], NULL, decode_worker, pool) != 0)
+      break;
+    pool->thread_count++;
+  }
+  if (pool->thread_count == 0) {
+    fprintf(stderr, "Warning: decode pool disabled, decoding inline\n");
+    pool->running = 0;
+    return -1;
+  }
+  return 0;
+}
+
+void decode_pool_shutdown(DecodePool *pool) {
+  pthread_mutex_lock(&pool->lock);
+  pool->running = 0;
+  pthread_cond_broadcast(&pool->work_cond);
+  pthread_mutex_unlock(&pool->lock);
+
+  for (int i = 0; i < pool->thread_count; i++)
+    pthread_join(pool->threads[i], NULL);
+  pool->thread_count = 0;
+
+  DecodeJob *job;
+  while ((job = pop_job(&pool->pending_head, &pool->pending_tail)))
+    free_job(job);
+  while ((job = pop_job(&pool->done_head, &pool->done_tail)))
+    free_job(job);
+
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->work_cond);
+}
+
+void decode_pool_submit(DecodePool *pool, PageBuffer *buf, int max_w,
+                        int max_h, DecodeDoneFn done, void *user, int key,
+                        unsigned gen) {
+  if (!buf)
+    return;
+
+  DecodeJob *job = calloc(1, sizeof(DecodeJob));
+  if (!job) {
+    page_buffer_release(buf);
+    return;
+  }
+  job->buf = buf;
+  job->max_w = max_w;
+  job->max_h = max_h;
+  job->done = done;
+  job->user = user;
+  job->key = key;
+  job->gen = gen;
+
+  pthread_mutex_lock(&pool->lock);
+  push_job(&pool->pending_head, &pool->pending_tail, job);
+  pthread_cond_signal(&pool->work_cond);
+  int inline_decode = !pool->running;
+  pthread_mutex_unlock(&pool->lock);
+
+  // Without workers the main loop decodes it, so make sure it comes round
+  if (inline_decode)
+    decode_pool_wake(pool);
+}
+
+// Drop matching jobs that haven't started and results not yet drained;
+// running ones are thrown away when they finish
+static void cancel_jobs(DecodePool *pool, void *user, int all, int key,
+                        unsigned gen) {
+  pthread_mutex_lock(&pool->lock);
+  drop_jobs(&pool->pending_head, &pool->pending_tail, user, all, key, gen);
+  drop_jobs(&pool->done_head, &pool->done_tail, user, all, key, gen);
+  for (int i = 0; i < DECODE_POOL_MAX_THREADS; i++) {
+    if (pool->active[i] && job_matches(pool->active[i], user, all, key, gen))
+      pool->active[i]->cancelled = 1;
+  }
+  pthread_mutex_unlock(&pool->lock);
+}
+
+void decode_pool_cancel(DecodePool *pool, void *user) {
+  cancel_jobs(pool, user, 1, 0, 0);
+}
+
+void decode_pool_cancel_job(DecodePool *pool, void *user, int key,
+                            unsigned gen) {
+  cancel_jobs(pool, user, 0, key, gen);
+}
+
+int decode_pool_drain(DecodePool *pool) {
+  atomic_store(&pool->wake_pending, 0);
+  int ran = 0;
+  for (;;) {
+    pthread_mutex_lock(&pool->lock);
+    DecodeJob *job = pop_job(&pool->done_head, &pool->done_tail);
+    // Without workers, decode here, one job per call
+    if (!job && !pool->running && ran == 0)
+      job = pop_job(&pool->pending_head, &pool->pending_tail);
+    pthread_mutex_unlock(&pool->lock);
+    if (!job)
+      break;
+
+    if (job->buf) {
+      job->surface =
+          decode_page(job->buf->data, job->buf->size, job->max_w, job->max_h);
+      page_buffer_release(job->buf);
+      job->buf = NULL;
+    }
+
+    // Callbacks run unlocked so they may submit or cancel jobs
+    if (job->done(pool->renderer, job->user, job->key, job->gen,
+                  job->surface))
+      job->surface = NULL;
+    free_job(job);
+    ran++;
+  }
+
+  // Inline decoding does one job per call; come back for the rest
+  pthread_mutex_lock(&pool->lock);
+  if (!pool->running && pool->pending_head)
+    decode_pool_wake(pool);
+  pthread_mutex_unlock(&pool->lock);
+  return ran;
+}
+
+void decode_pool_wake(DecodePool *pool) {
+  if (pool->wake_event == (Uint32)-1 ||
+      atomic_exchange(&pool->wake_pending, 1))
+    return;
+  SDL_Event event;
+  memset(&event, 0, sizeof(event));
+  event.type = pool->wake_event;
+  SDL_PushEvent(&event);
+}
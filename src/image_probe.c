@@ -0,0 +1,101 @@
+#include "image_probe.h"
+#include <string.h>
+
+// --- Internal helpers ---
+
+static unsigned be16(const unsigned char *p) { return p[0] << 8 | p[1]; }
+
+static unsigned long be32(const unsigned char *p) {
+  return (unsigned long)p[0] << 24 | (unsigned long)p[1] << 16 |
+         (unsigned long)p[2] << 8 | p[3];
+}
+
+static unsigned le16(const unsigned char *p) { return p[0] | p[1] << 8; }
+
+static unsigned long le24(const unsigned char *p) {
+  return p[0] | (unsigned long)p[1] << 8 | (unsigned long)p[2] << 16;
+}
+
+static int probe_png(const unsigned char *d, size_t size, PageSize *out) {
+  // Signature, then the IHDR chunk always comes first
+  if (size < 24 || memcmp(d + 12, "IHDR", 4) != 0)
+    return -1;
+  out->w = (int)be32(d + 16);
+  out->h = (int)be32(d + 20);
+  return 0;
+}
+
+// Walk the marker segments up to the first start-of-frame
+static int probe_jpeg(const unsigned char *d, size_t size, PageSize *out) {
+  size_t pos = 2;
+  while (pos + 4 <= size) {
+    if (d[pos] != 0xFF)
+      return -1;
+    unsigned char marker = d[pos + 1];
+    if (marker == 0xFF) { // fill byte
+      pos++;
+      continue;
+    }
+    if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+      pos += 2; // no length
+      continue;
+    }
+    if (marker == 0xDA || marker == 0xD9) // scan data or end: no frame
+      return -1;
+    // SOF0..SOF15, except DHT, JPG and DAC which share the range
+    if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 &&
+        marker != 0xC8 && marker != 0xCC) {
+      if (pos + 9 > size)
+        return -1;
+      out->h = (int)be16(d + pos + 5);
+      out->w = (int)be16(d + pos + 7);
+      return 0;
+    }
+    pos += 2 + be16(d + pos + 2);
+  }
+  return -1;
+}
+
+static int probe_webp(const unsigned char *d, size_t size, PageSize *out) {
+  if (size < 30)
+    return -1;
+  if (memcmp(d + 12, "VP8 ", 4) == 0) {
+    // Frame tag, start code, then 14-bit width and height
+    if (d[23] != 0x9D || d[24] != 0x01 || d[25] != 0x2A)
+      return -1;
+    out->w = (int)(le16(d + 26) & 0x3FFF);
+    out->h = (int)(le16(d + 28) & 0x3FFF);
+    return 0;
+  }
+  if (memcmp(d + 12, "VP8L", 4) == 0) {
+    if (d[20] != 0x2F)
+      return -1;
+    out->w = 1 + (int)(d[21] | (d[22] & 0x3F) << 8);
+    out->h = 1 + (int)(d[22] >> 6 | d[23] << 2 | (d[24] & 0x0F) << 10);
+    return 0;
+  }
+  if (memcmp(d + 12, "VP8X", 4) == 0) {
+    out->w = 1 + (int)le24(d + 24);
+    out->h = 1 + (int)le24(d + 27);
+    return 0;
+  }
+  return -1;
+}
+
+// --- Public API ---
+
+int probe_image_size(const unsigned char *data, size_t size, PageSize *out) {
+  PageSize s = {0, 0};
+  int rc = -1;
+  if (size >= 8 && memcmp(data, "\x89PNG\r\n\x1a\n", 8) == 0)
+    rc = probe_png(data, size, &s);
+  else if (size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF)
+    rc = probe_jpeg(data, size, &s);
+  else if (size >= 12 && memcmp(data, "RIFF", 4) == 0 &&
+           memcmp(data + 8, "WEBP", 4) == 0)
+    rc = probe_webp(data, size, &s);
+  if (rc != 0 || s.w <= 0 || s.h <= 0)
+    return -1;
+  *out = s;
+  return 0;
+}
@@ -0,0 +1,143 @@
+#include "jpeg_decode.h"
+#include "resample.h"
+#include <setjmp.h>
+#include <stdio.h>
+#include <jpeglib.h>
+
+// libjpeg reports fatal errors through error_exit, which must not return
+typedef struct {
+  struct jpeg_error_mgr mgr;
+  jmp_buf jump;
+} JpegError;
+
+static void jpeg_error_exit(j_common_ptr cinfo) {
+  JpegError *err = (JpegError *)cinfo->err;
+  longjmp(err->jump, 1);
+}
+
+// Corrupt-data warnings are common in scans and harmless; stay quiet
+static void jpeg_output_message(j_common_ptr cinfo) { (void)cinfo; }
+
+#ifdef JCS_ALPHA_EXTENSIONS
+// libjpeg-turbo colour spaces laying pixels out like each SDL format in
+// memory. The alpha or padding byte is filled with 0xFF.
+static const struct {
+  Uint32 format;
+  J_COLOR_SPACE space;
+} output_spaces[] = {
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+    {SDL_PIXELFORMAT_ARGB8888, JCS_EXT_BGRA},
+    {SDL_PIXELFORMAT_ABGR8888, JCS_EXT_RGBA},
+    {SDL_PIXELFORMAT_RGB888, JCS_EXT_BGRX},
+    {SDL_PIXELFORMAT_BGR888, JCS_EXT_RGBX},
+#else
+    {SDL_PIXELFORMAT_ARGB8888, JCS_EXT_ARGB},
+    {SDL_PIXELFORMAT_ABGR8888, JCS_EXT_ABGR},
+    {SDL_PIXELFORMAT_RGB888, JCS_EXT_XRGB},
+    {SDL_PIXELFORMAT_BGR888, JCS_EXT_XBGR},
+#endif
+};
+
+static int output_space(Uint32 format, J_COLOR_SPACE *space) {
+  for (int i = 0; i < (int)(sizeof(output_spaces) / sizeof(output_spaces[0]));
+       i++) {
+    if (output_spaces[i].format == format) {
+      *space = output_spaces[i].space;
+      return 0;
+    }
+  }
+  return -1;
+}
+#endif
+
+// Largest power-of-two reduction (up to 1/8) that keeps the image at least
+// target_w x target_h. libjpeg rounds scaled sizes up.
+static int pick_scale_denom(int w, int h, int target_w, int target_h) {
+  int denom = 8;
+  while (denom > 1 && ((w + denom - 1) / denom < target_w ||
+                       (h + denom - 1) / denom < target_h))
+    denom /= 2;
+  return denom;
+}
+
+SDL_Surface *jpeg_decode(const char *data, size_t size, int max_w, int max_h,
+                         Uint32 format) {
+  if (!data || size < 3 || (unsigned char)data[0] != 0xFF ||
+      (unsigned char)data[1] != 0xD8)
+    return NULL;
+
+  J_COLOR_SPACE space = JCS_RGB;
+#ifdef JCS_ALPHA_EXTENSIONS
+  if (output_space(format, &space) != 0)
+    return NULL;
+#else
+  // Any 4-byte layout will do (RGB888 and BGR888 count as 24 bits per
+  // pixel but take 4 bytes)
+  if (SDL_BYTESPERPIXEL(format) != 4)
+    return NULL;
+#endif
+
+  struct jpeg_decompress_struct cinfo;
+  JpegError err;
+  SDL_Surface *volatile surface = NULL;
+
+  cinfo.err = jpeg_std_error(&err.mgr);
+  err.mgr.error_exit = jpeg_error_exit;
+  err.mgr.output_message = jpeg_output_message;
+  if (setjmp(err.jump)) {
+    jpeg_destroy_decompress(&cinfo);
+    if (surface)
+      SDL_FreeSurface(surface);
+    return NULL;
+  }
+
+  jpeg_create_decompress(&cinfo);
+  jpeg_mem_src(&cinfo, (unsigned char *)data, (unsigned long)size);
+  jpeg_read_header(&cinfo, TRUE);
+
+  // CMYK/YCCK can't be converted to RGB by libjpeg; SDL_image handles them
+  if (cinfo.jpeg_color_space == JCS_CMYK ||
+      cinfo.jpeg_color_space == JCS_YCCK) {
+    jpeg_destroy_decompress(&cinfo);
+    return NULL;
+  }
+
+  int target_w, target_h;
+  if (resample_fit(cinfo.image_width, cinfo.image_height, max_w, max_h,
+                   &target_w, &target_h)) {
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = pick_scale_denom(
+        cinfo.image_width, cinfo.image_height, target_w, target_h);
+  }
+
+  // libjpeg-turbo writes the surface's layout directly; plain libjpeg gives
+  // RGB, which is expanded in place below
+  cinfo.out_color_space = space;
+  jpeg_start_decompress(&cinfo);
+
+  surface = SDL_CreateRGBSurfaceWithFormat(
+      0, cinfo.output_width, cinfo.output_height, 32, format);
+  if (!surface) {
+    jpeg_destroy_decompress(&cinfo);
+    return NULL;
+  }
+
+  while (cinfo.output_scanline < cinfo.output_height) {
+    Uint8 *row = (Uint8 *)surface->pixels +
+                 (size_t)cinfo.output_scanline * surface->pitch;
+    JSAMPROW rows[1] = {row};
+    jpeg_read_scanlines(&cinfo, rows, 1);
+#ifndef JCS_ALPHA_EXTENSIONS
+    // 3 bytes per pixel -> 4, back to front so nothing is overwritten early
+    for (int x = (int)cinfo.output_width - 1; x >= 0; x--) {
+      Uint8 *px = row + x * 3;
+      ((Uint32 *)row)[x] =
+          SDL_MapRGBA(surface->format, px[0], px[1], px[2], 0xFF);
+    }
+#endif
+  }
+
+  jpeg_finish_decompress(&cinfo);
+  jpeg_destroy_decompress(&cinfo);
+  return surface;
+}
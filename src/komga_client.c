@@ -9,6 +9,7 @@
 static void httpbuf_init(HttpBuffer *buf) {
   buf->capacity = 4096;
   buf->size = 0;
+  buf->limit = 0;
   buf->data = malloc(buf->capacity);
 }
 
@@ -23,6 +24,8 @@ static size_t write_callback(void *contents, size_t size, size_t nmemb,
                              void *userp) {
   size_t total = size * nmemb;
   HttpBuffer *buf = (HttpBuffer *)userp;
+  if (buf->limit && buf->size >= buf->limit)
+    return 0; // enough, abort the transfer
 
   while (buf->size + total >= buf->capacity) {
     buf->capacity *= 2;
@@ -38,28 +41,43 @@ static size_t write_callback(void *contents, size_t size, size_t nmemb,
 
 // --- Internal helpers ---
 
-static void setup_auth(KomgaClient *client) {
+// Apply credentials to an easy handle. Returns the header list the handle
+// now points at (NULL if none); it must outlive the transfer.
+static struct curl_slist *apply_auth(const KomgaClient *client, CURL *curl) {
+  struct curl_slist *headers = NULL;
   if (client->api_key[0]) {
-    struct curl_slist *headers = NULL;
     char header[300];
     snprintf(header, sizeof(header), "X-API-Key: %s", client->api_key);
     headers = curl_slist_append(headers, header);
-    curl_easy_setopt(client->curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
   } else if (client->username[0]) {
     char userpwd[300];
     snprintf(userpwd, sizeof(userpwd), "%s:%s", client->username,
              client->password);
-    curl_easy_setopt(client->curl, CURLOPT_USERPWD, userpwd);
+    curl_easy_setopt(curl, CURLOPT_USERPWD, userpwd);
   }
+  return headers;
+}
+
+static void setup_auth(KomgaClient *client) {
+  apply_auth(client, client->curl);
 }
 
-// Perform a GET request. Returns 0 on success with data in buf.
+// Perform a GET request, of only the first max_bytes if set (0 = all of
+// it). Returns 0 on success with data in buf.
 // Caller must call httpbuf_free(buf) when done.
-static int do_get(KomgaClient *client, const char *url, HttpBuffer *buf) {
+static int do_get_range(KomgaClient *client, const char *url,
+                        size_t max_bytes, HttpBuffer *buf) {
   httpbuf_init(buf);
+  buf->limit = max_bytes;
 
   curl_easy_reset(client->curl);
   curl_easy_setopt(client->curl, CURLOPT_URL, url);
+  if (max_bytes) {
+    char range[32];
+    snprintf(range, sizeof(range), "0-%zu", max_bytes - 1);
+    curl_easy_setopt(client->curl, CURLOPT_RANGE, range);
+  }
   curl_easy_setopt(client->curl, CURLOPT_WRITEFUNCTION, write_callback);
   curl_easy_setopt(client->curl, CURLOPT_WRITEDATA, buf);
   curl_easy_setopt(client->curl, CURLOPT_TIMEOUT, 30L);
@@ -67,6 +85,9 @@ static int do_get(KomgaClient *client, const char *url, HttpBuffer *buf) {
   setup_auth(client);
 
   CURLcode res = curl_easy_perform(client->curl);
+  // A server ignoring the range is cut off by write_callback
+  if (res == CURLE_WRITE_ERROR && buf->limit && buf->size >= buf->limit)
+    res = CURLE_OK;
   if (res != CURLE_OK) {
     fprintf(stderr, "GET %s failed: %s\n", url, curl_easy_strerror(res));
     httpbuf_free(buf);
@@ -84,6 +105,10 @@ static int do_get(KomgaClient *client, const char *url, HttpBuffer *buf) {
   return 0;
 }
 
+static int do_get(KomgaClient *client, const char *url, HttpBuffer *buf) {
+  return do_get_range(client, url, 0, buf);
+}
+
 // Perform a GET that returns binary data. Returns malloc'd buffer.
 static char *do_get_binary(KomgaClient *client, const char *url,
                            size_t *out_size) {
@@ -413,6 +438,112 @@ char *komga_get_page(KomgaClient *client, const char *book_id, int page_num,
   return do_get_binary(client, url, out_size);
 }
 
+char *komga_get_page_thumbnail(KomgaClient *client, const char *book_id,
+                               int page_num, size_t *out_size) {
+  char url[700];
+  snprintf(url, sizeof(url), "%s/api/v1/books/%s/pages/%d/thumbnail",
+           client->base_url, book_id, page_num);
+  return do_get_binary(client, url, out_size);
+}
+
+char *komga_get_page_head(KomgaClient *client, const char *book_id,
+                          int page_num, size_t max_bytes, size_t *out_size) {
+  char url[700];
+  snprintf(url, sizeof(url), "%s/api/v1/books/%s/pages/%d", client->base_url,
+           book_id, page_num);
+  HttpBuffer buf;
+  if (do_get_range(client, url, max_bytes, &buf) != 0)
+    return NULL;
+  *out_size = buf.size;
+  return buf.data; // caller frees
+}
+
+static int transfer_begin(KomgaClient *client, KomgaTransfer *t,
+                          const char *url) {
+  if (!t->easy) {
+    t->easy = curl_easy_init();
+    if (!t->easy)
+      return -1;
+  } else {
+    curl_easy_reset(t->easy);
+  }
+  if (t->headers) {
+    curl_slist_free_all(t->headers);
+    t->headers = NULL;
+  }
+  httpbuf_init(&t->body);
+  if (!t->body.data)
+    return -1;
+
+  curl_easy_setopt(t->easy, CURLOPT_URL, url);
+  curl_easy_setopt(t->easy, CURLOPT_WRITEFUNCTION, write_callback);
+  curl_easy_setopt(t->easy, CURLOPT_WRITEDATA, &t->body);
+  curl_easy_setopt(t->easy, CURLOPT_TIMEOUT, 30L);
+  curl_easy_setopt(t->easy, CURLOPT_CONNECTTIMEOUT, 10L);
+  // Multiplex over one HTTP/2 connection when the server offers it
+  curl_easy_setopt(t->easy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+  curl_easy_setopt(t->easy, CURLOPT_PIPEWAIT, 1L);
+  t->headers = apply_auth(client, t->easy);
+  return 0;
+}
+
+int komga_transfer_begin_page(KomgaClient *client, KomgaTransfer *t,
+                              const char *book_id, int page_num) {
+  char url[700];
+  snprintf(url, sizeof(url), "%s/api/v1/books/%s/pages/%d", client->base_url,
+           book_id, page_num);
+  return transfer_begin(client, t, url);
+}
+
+int komga_transfer_begin_page_thumbnail(KomgaClient *client, KomgaTransfer *t,
+                                        const char *book_id, int page_num) {
+  char url[700];
+  snprintf(url, sizeof(url), "%s/api/v1/books/%s/pages/%d/thumbnail",
+           client->base_url, book_id, page_num);
+  return transfer_begin(client, t, url);
+}
+
+char *komga_transfer_finish(KomgaTransfer *t, CURLcode result,
+                            size_t *out_size) {
+  char *url = NULL;
+  curl_easy_getinfo(t->easy, CURLINFO_EFFECTIVE_URL, &url);
+  if (!url)
+    url = "(page)";
+
+  if (result != CURLE_OK) {
+    // Cancelled by the caller's progress callback: not an error
+    if (result != CURLE_ABORTED_BY_CALLBACK)
+      fprintf(stderr, "GET %s failed: %s\n", url, curl_easy_strerror(result));
+    httpbuf_free(&t->body);
+    return NULL;
+  }
+
+  long http_code = 0;
+  curl_easy_getinfo(t->easy, CURLINFO_RESPONSE_CODE, &http_code);
+  if (http_code < 200 || http_code >= 300) {
+    fprintf(stderr, "GET %s returned HTTP %ld\n", url, http_code);
+    httpbuf_free(&t->body);
+    return NULL;
+  }
+
+  char *data = t->body.data;
+  *out_size = t->body.size;
+  t->body.data = NULL;
+  t->body.size = 0;
+  t->body.capacity = 0;
+  return data; // caller frees
+}
+
+void komga_transfer_cleanup(KomgaTransfer *t) {
+  if (t->easy)
+    curl_easy_cleanup(t->easy);
+  if (t->headers)
+    curl_slist_free_all(t->headers);
+  httpbuf_free(&t->body);
+  t->easy = NULL;
+  t->headers = NULL;
+}
+
 int komga_download_book(KomgaClient *client, const char *book_id,
                         const char *save_path) {
   char url[700];
@@ -535,3 +666,42 @@ int komga_get_book_details(KomgaClient *client, const char *book_id,
   cJSON_Delete(root);
   return 0;
 }
+
+int komga_get_page_sizes(KomgaClient *client, const char *book_id,
+                         PageSize *sizes, int count) {
+  char url[700];
+  snprintf(url, sizeof(url), "%s/api/v1/books/%s/pages", client->base_url,
+           book_id);
+
+  HttpBuffer buf;
+  if (do_get(client, url, &buf) != 0)
+    return -1;
+
+  buf.data = realloc(buf.data, buf.size + 1);
+  buf.data[buf.size] = '\0';
+
+  cJSON *root = cJSON_Parse(buf.data);
+  httpbuf_free(&buf);
+  if (!cJSON_IsArray(root)) {
+    cJSON_Delete(root);
+    return -1;
+  }
+
+  cJSON *item;
+  cJSON_ArrayForEach(item, root) {
+    cJSON *number = cJSON_GetObjectItem(item, "number");
+    cJSON *width = cJSON_GetObjectItem(item, "width");
+    cJSON *height = cJSON_GetObjectItem(item, "height");
+    if (!cJSON_IsNumber(number) || !cJSON_IsNumber(width) ||
+        !cJSON_IsNumber(height))
+      continue; // not analysed yet
+    int index = number->valueint - 1;
+    if (index >= 0 && index < count && width->valueint > 0 &&
+        height->valueint > 0) {
+      sizes[index].w = width->valueint;
+      sizes[index].h = height->valueint;
+    }
+  }
+  cJSON_Delete(root);
+  return 0;
+}
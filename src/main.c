@@ -18,6 +18,12 @@ ManhwaScale manhwa_scale = SCALE_FIT_HEIGHT;
 int show_help = 0;
 int scroll_y = 0;
 
+// Webtoon position as a share of the current page's height, so the view
+// stays on the same spot when that height changes (see settle_strip())
+int strip_page = -1;
+int strip_page_h = 0;
+double strip_frac = 0;
+
 // --- File Navigation State ---
 char current_file_path[1024];
 int prompt_next = 0;
@@ -25,101 +31,245 @@ char next_file_path[1024];
 
 void reset_view() {
   scroll_y = 0;
+  strip_page = -1;
   prompt_next = 0;
 }
 
-void load_new_file(MangaBook *book, AppContext *app, const char *new_path);
-void refresh_page(MangaBook *book, AppContext *app);
+// --- Event Loop Helpers ---
+#define IDLE_WAIT_MS 500 // longest sleep of an idle loop
+
+// Next event: poll when a frame is due, otherwise sleep until input arrives
+// or background work wakes us. Returns 0 when there is none.
+static int next_event(AppContext *app, SDL_Event *e) {
+  if (app->dirty)
+    return SDL_PollEvent(e);
+  // A resize waiting to settle needs a look once it has
+  int timeout = app->resize_pending ? DECODE_RESIZE_DELAY_MS : IDLE_WAIT_MS;
+  return SDL_WaitEventTimeout(e, timeout);
+}
+
+// Whether an event may change what is on screen. Nothing reacts to pointer
+// motion, and wakeups only matter through the loads they complete.
+static int event_redraws(AppContext *app, const SDL_Event *e) {
+  return e->type != SDL_MOUSEMOTION && e->type != app->decode_pool.wake_event;
+}
+
+void load_new_file(PageProvider *prov, AppContext *app, const char *new_path);
+void refresh_page(PageProvider *prov, AppContext *app);
 void toggle_fullscreen(AppContext *app);
 ReadMode detect_mode(const char *path);
+static double page_offset(PageProvider *prov, AppContext *app);
+static void resume_strip(PageProvider *prov, AppContext *app, double offset);
 
 // --- Forward declarations for Komga reader ---
 void refresh_page_komga(PageProvider *prov, AppContext *app);
 
 // ==========================================================
-// LOCAL FILE HELPERS (unchanged from original)
+// LOCAL FILE HELPERS
 // ==========================================================
 
-void load_new_file(MangaBook *book, AppContext *app, const char *new_path) {
-  save_bookmark(current_file_path, book->current_index);
-  close_cbz(book);
+void load_new_file(PageProvider *prov, AppContext *app, const char *new_path) {
+  save_bookmark(current_file_path, prov->current_index,
+                page_offset(prov, app));
+  provider_close(prov);
+  clear_slots(app);
+  scrubber_reset(&app->scrubber);
 
-  if (open_cbz(new_path, book) != 0) {
+  if (provider_open_local(prov, new_path) != 0) {
     printf("Failed to open %s\n", new_path);
     exit(1);
   }
   strncpy(current_file_path, new_path, 1023);
 
   // Auto-detect Mode
-  char lower[1024];
-  strncpy(lower, new_path, 1023);
-  for (int i = 0; lower[i]; i++)
-    lower[i] = tolower(lower[i]);
+  prov->read_mode = detect_mode(new_path);
 
-  if (strstr(lower, "manhwa") || strstr(lower, "webtoon"))
-    book->mode = MODE_MANHWA;
-  else if (strstr(lower, "manhua"))
-    book->mode = MODE_MANHUA;
-  else if (strstr(lower, "comic"))
-    book->mode = MODE_COMIC;
-  else
-    book->mode = MODE_MANGA;
-
-  if (book->mode == MODE_MANHWA) {
+  if (prov->read_mode == MODE_MANHWA) {
     view_mode = VIEW_MANHWA;
     manhwa_scale = SCALE_FIT_HEIGHT;
   } else {
     view_mode = VIEW_SINGLE;
   }
 
-  int saved = load_bookmark(new_path);
-  book->current_index = (saved > 0 && saved < book->count) ? saved : 0;
+  double offset = 0;
+  int saved = load_bookmark(new_path, &offset);
+  prov->current_index = (saved > 0 && saved < prov->count) ? saved : 0;
   reset_view();
+  if (prov->current_index == saved)
+    resume_strip(prov, app, offset);
 }
 
-void refresh_page(MangaBook *book, AppContext *app) {
-  size_t size;
-  char *data;
-
-  // 1. CURRENT
-  data = get_image_data(book, &size);
-  load_texture_to_slot(app, data, size, 0);
-  if (data)
-    free(data);
+// Upload a page straight from the decoded image a worker prepared when
+// there is one, otherwise hand its bytes to the decode pool. Pages the
+// texture ring still holds are left alone. Without wait, a page that isn't
+// in memory yet is only requested; a later frame picks it up.
+//
+// Visible pages (wait) get a low-resolution stand-in first when they are
+// not at hand: a 1/8 size decode of a local page, or Komga's thumbnail of a
+// page still downloading. Komga pages are never waited for; the reader
+// loop calls this again once they land.
+static void load_page_texture(PageProvider *prov, AppContext *app, int index,
+                              int wait) {
+  if (page_texture_loaded(app, index))
+    return;
 
-  // 2. NEXT
-  int load_next = (view_mode == VIEW_MANHWA || view_mode == VIEW_DOUBLE);
-  if (view_mode == VIEW_DOUBLE_COVER && book->current_index > 0)
-    load_next = 1;
+  SDL_Surface *surface = provider_borrow_decoded(prov, index, wait);
+  if (surface) {
+    load_surface_to_page(app, surface, index);
+    provider_release_decoded(prov, index);
+    return;
+  }
 
-  if (load_next && (book->current_index + 1 < book->count)) {
-    book->current_index++;
-    data = get_image_data(book, &size);
-    load_texture_to_slot(app, data, size, 1);
-    if (data)
-      free(data);
-    book->current_index--;
-  } else {
-    load_texture_to_slot(app, NULL, 0, 1);
+  if (wait && prov->type == SOURCE_KOMGA_STREAM && prov->prefetch_running) {
+    PageBuffer *buf = provider_try_borrow_page(prov, index);
+    if (buf) {
+      queue_page_decode(app, buf, index);
+      return;
+    }
+    PageBuffer *preview = provider_borrow_preview(prov, index);
+    if (preview)
+      queue_preview_decode(app, preview, index, 0);
+    return;
   }
 
-  // 3. PREVIOUS
-  if (view_mode == VIEW_MANHWA && book->current_index > 0) {
-    book->current_index--;
-    data = get_image_data(book, &size);
-    load_texture_to_slot(app, data, size, -1);
-    if (data)
-      free(data);
-    book->current_index++;
-  } else {
-    load_texture_to_slot(app, NULL, 0, -1);
+  PageBuffer *buf = wait ? provider_borrow_page(prov, index)
+                         : provider_try_borrow_page(prov, index);
+  if (buf && wait)
+    queue_preview_decode(app, page_buffer_retain(buf), index, 1);
+  if (buf || wait)
+    queue_page_decode(app, buf, index);
+}
+
+// Hand the renderer the page sizes measured so far; the strip is laid out
+// with them
+static void sync_page_sizes(PageProvider *prov, AppContext *app) {
+  if (provider_sync_sizes(prov) || app->page_sizes != prov->page_sizes ||
+      app->page_count != prov->count)
+    set_page_sizes(app, prov->page_sizes, prov->count);
+}
+
+// Webtoon mode: keep as many pages uploaded as cover the viewport plus the
+// strip margin. Runs every frame; only pages new to the strip are loaded,
+// and none of them blocks.
+static void update_strip(PageProvider *prov, AppContext *app) {
+  sync_page_sizes(prov, app);
+  int cur = prov->current_index;
+  int first, last;
+  strip_span(app, manhwa_scale, scroll_y, cur, prov->count, &first, &last);
+  set_slot_window(app, cur, first, last);
+  provider_set_span(prov, -first, last);
+
+  for (int slot = 1; slot <= last; slot++)
+    load_page_texture(prov, app, cur + slot, 0);
+  for (int slot = -1; slot >= first; slot--)
+    load_page_texture(prov, app, cur + slot, 0);
+}
+
+// Point the texture ring at the current page and load whichever visible
+// pages it doesn't hold yet
+static void show_pages(PageProvider *prov, AppContext *app) {
+  int cur = prov->current_index;
+  update_decode_size(app, view_mode, manhwa_scale);
+  provider_set_decode_size(prov, app->decode_w, app->decode_h);
+  if (view_mode == VIEW_MANHWA) {
+    update_strip(prov, app);
+    load_page_texture(prov, app, cur, 1);
+    return;
   }
+  provider_set_span(prov, 0, 0);
+
+  int load_next = (view_mode == VIEW_DOUBLE);
+  if (view_mode == VIEW_DOUBLE_COVER && cur > 0)
+    load_next = 1;
+  int last = (load_next && cur + 1 < prov->count) ? 1 : 0;
+  set_slot_window(app, cur, 0, last);
+
+  // Queue the facing page so it downloads alongside the visible one
+  if (last == 1 && !page_texture_loaded(app, cur + 1))
+    provider_request_page(prov, cur + 1, FETCH_ADJACENT);
+
+  // 1. CURRENT
+  load_page_texture(prov, app, cur, 1);
+
+  // 2. NEXT
+  if (last == 1)
+    load_page_texture(prov, app, cur + 1, 1);
+}
+
+void refresh_page(PageProvider *prov, AppContext *app) {
+  show_pages(prov, app);
 
   char title[256];
-  const char *mode_str = (book->mode == MODE_MANHWA) ? "Manhwa" : "Reader";
+  const char *mode_str = (prov->read_mode == MODE_MANHWA) ? "Manhwa" : "Reader";
   snprintf(title, sizeof(title), "%s - Page %d / %d", mode_str,
-           book->current_index + 1, book->count);
+           prov->current_index + 1, prov->count);
   SDL_SetWindowTitle(app->window, title);
+
+  // Let the workers move their window along
+  provider_notify_prefetch(prov);
+}
+
+// ==========================================================
+// WEBTOON POSITION (both readers)
+// ==========================================================
+
+// Remember how far into the current page the webtoon view is
+static void note_strip_position(PageProvider *prov, AppContext *app) {
+  strip_page = prov->current_index;
+  strip_page_h = strip_page_height(app, manhwa_scale, strip_page);
+  strip_frac = strip_page_h > 0 ? (double)scroll_y / strip_page_h : 0;
+}
+
+// Keep scroll_y the same share of the current page when its height changed
+// (resize, a page measured or decoded), then move current_index to the page
+// scroll_y has reached, however far that is. Returns how many pages it
+// moved (negative = up).
+static int settle_strip(PageProvider *prov, AppContext *app) {
+  int cur = prov->current_index;
+  int h = strip_page_height(app, manhwa_scale, cur);
+  if (cur == strip_page && h > 0 && strip_page_h > 0 && h != strip_page_h)
+    scroll_y = (int)(strip_frac * h + 0.5);
+
+  long long pos = strip_position(app, manhwa_scale, cur, scroll_y);
+  prov->current_index =
+      strip_locate(app, manhwa_scale, pos > 0 ? pos : 0, &scroll_y);
+  note_strip_position(prov, app);
+  return prov->current_index - cur;
+}
+
+// Webtoon position within the current page as a share of its height, for
+// bookmarks (0 in the paged views)
+static double page_offset(PageProvider *prov, AppContext *app) {
+  if (view_mode != VIEW_MANHWA || scroll_y <= 0)
+    return 0;
+  int h = strip_page_height(app, manhwa_scale, prov->current_index);
+  double offset = h > 0 ? (double)scroll_y / h : 0;
+  return offset < 1 ? offset : 0;
+}
+
+// Scroll a freshly opened book to where its bookmark left off: offset (a
+// share of the page height) into the current page. The page need not be
+// measured yet; its position is kept as a share until it is.
+static void resume_strip(PageProvider *prov, AppContext *app, double offset) {
+  if (view_mode != VIEW_MANHWA || offset <= 0)
+    return;
+  sync_page_sizes(prov, app);
+  strip_page = prov->current_index;
+  strip_page_h = strip_page_height(app, manhwa_scale, strip_page);
+  strip_frac = offset;
+  scroll_y = (int)(offset * strip_page_h + 0.5);
+}
+
+// Show the end of the strip: the last page's bottom edge at the bottom of
+// the window
+static void strip_jump_end(PageProvider *prov, AppContext *app) {
+  int win_w, win_h;
+  SDL_GetRendererOutputSize(app->renderer, &win_w, &win_h);
+  sync_page_sizes(prov, app);
+  long long pos = strip_length(app, manhwa_scale) - win_h;
+  prov->current_index =
+      strip_locate(app, manhwa_scale, pos > 0 ? pos : 0, &scroll_y);
+  note_strip_position(prov, app);
 }
 
 void toggle_fullscreen(AppContext *app) {
@@ -144,42 +294,115 @@ ReadMode detect_mode(const char *path) {
 }
 
 // ==========================================================
-// KOMGA READER HELPERS
+// PAGE SCRUBBER (both readers)
 // ==========================================================
 
-void refresh_page_komga(PageProvider *prov, AppContext *app) {
-  size_t size;
-  char *data;
-
-  // 1. CURRENT
-  data = provider_get_page(prov, prov->current_index, &size);
-  load_texture_to_slot(app, data, size, 0);
-  if (data)
-    free(data);
+// Feed the scrubber's atlas: thumbnails that finished decoding go in, the
+// ones still missing around the scrub position are asked for
+static void update_scrubber(PageProvider *prov, AppContext *app) {
+  Scrubber *s = &app->scrubber;
+  int first, last;
+  scrubber_range(s, &first, &last);
+  provider_focus_thumbnails(prov, first, last, s->index); // closed: none
+  for (int i = first; i <= last; i++) {
+    if (scrubber_has(s, i))
+      continue;
+    SDL_Surface *thumb = provider_take_thumbnail(prov, i);
+    if (thumb) {
+      scrubber_store(s, app->renderer, i, thumb);
+      SDL_FreeSurface(thumb);
+      app->dirty = 1;
+    } else {
+      provider_want_thumbnail(prov, i, SCRUB_THUMB_W, SCRUB_THUMB_H);
+    }
+  }
+}
 
-  // 2. NEXT
-  int load_next = (view_mode == VIEW_MANHWA || view_mode == VIEW_DOUBLE);
-  if (view_mode == VIEW_DOUBLE_COVER && prov->current_index > 0)
-    load_next = 1;
+// Mouse events come in window coordinates, the bar is laid out in output
+// pixels (they differ on HiDPI screens)
+static void window_to_output(AppContext *app, int *x, int *y) {
+  int win_w, win_h, out_w, out_h;
+  SDL_GetWindowSize(app->window, &win_w, &win_h);
+  if (SDL_GetRendererOutputSize(app->renderer, &out_w, &out_h) != 0 ||
+      win_w <= 0 || win_h <= 0)
+    return;
+  *x = *x * out_w / win_w;
+  *y = *y * out_h / win_h;
+}
 
-  if (load_next && (prov->current_index + 1 < prov->count)) {
-    data = provider_get_page(prov, prov->current_index + 1, &size);
-    load_texture_to_slot(app, data, size, 1);
-    if (data)
-      free(data);
-  } else {
-    load_texture_to_slot(app, NULL, 0, 1);
+// Input while the scrubber is open. Moving it only redraws the bar; the
+// reader goes to the page once the scrub is committed (Enter, or letting go
+// of the mouse), which returns 1.
+static int scrubber_event(PageProvider *prov, AppContext *app,
+                          const SDL_Event *e) {
+  Scrubber *s = &app->scrubber;
+  int moved = 0, commit = 0;
+  int x, y;
+  if (e->type == SDL_KEYDOWN) {
+    int step = (SDL_GetModState() & KMOD_SHIFT) ? 10 : 1;
+    switch (e->key.keysym.sym) {
+    case SDLK_LEFT:
+      moved = scrubber_set(s, s->index - step);
+      break;
+    case SDLK_RIGHT:
+      moved = scrubber_set(s, s->index + step);
+      break;
+    case SDLK_RETURN:
+      commit = 1;
+      break;
+    case SDLK_t:
+    case SDLK_ESCAPE:
+      scrubber_close(s);
+      break;
+    }
+  } else if (e->type == SDL_MOUSEWHEEL) {
+    moved = scrubber_set(s, s->index - e->wheel.y);
+  } else if (e->type == SDL_MOUSEBUTTONDOWN &&
+             e->button.button == SDL_BUTTON_LEFT) {
+    x = e->button.x;
+    y = e->button.y;
+    window_to_output(app, &x, &y);
+    moved = scrubber_press(s, x, y);
+  } else if (e->type == SDL_MOUSEMOTION && s->dragging) {
+    x = e->motion.x;
+    y = e->motion.y;
+    window_to_output(app, &x, &y);
+    moved = scrubber_motion(s, x);
+  } else if (e->type == SDL_MOUSEBUTTONUP &&
+             e->button.button == SDL_BUTTON_LEFT) {
+    commit = scrubber_release(s);
   }
+  if (moved)
+    app->dirty = 1;
+  if (!commit)
+    return 0;
+
+  scrubber_close(s);
+  prov->current_index = s->index;
+  // Facing pages start on the same side as when paging through
+  if (view_mode == VIEW_DOUBLE_COVER && prov->current_index > 0 &&
+      prov->current_index % 2 == 0)
+    prov->current_index--;
+  else if (view_mode == VIEW_DOUBLE && prov->current_index % 2 != 0)
+    prov->current_index--;
+  reset_view();
+  app->dirty = 1;
+  return 1;
+}
 
-  // 3. PREVIOUS
-  if (view_mode == VIEW_MANHWA && prov->current_index > 0) {
-    data = provider_get_page(prov, prov->current_index - 1, &size);
-    load_texture_to_slot(app, data, size, -1);
-    if (data)
-      free(data);
-  } else {
-    load_texture_to_slot(app, NULL, 0, -1);
-  }
+// ==========================================================
+// KOMGA READER HELPERS
+// ==========================================================
+
+// Report a webtoon scroll to the prefetcher, measured in pages
+static void note_scroll(PageProvider *prov, AppContext *app, int delta_px) {
+  int h = get_scaled_height(app, 0, manhwa_scale);
+  if (h > 0)
+    provider_note_scroll(prov, (double)delta_px / h);
+}
+
+void refresh_page_komga(PageProvider *prov, AppContext *app) {
+  show_pages(prov, app);
 
   char title[256];
   const char *mode_str = (prov->read_mode == MODE_MANHWA) ? "Manhwa" : "Reader";
@@ -192,30 +415,35 @@ void refresh_page_komga(PageProvider *prov, AppContext *app) {
 }
 
 // ==========================================================
-// RUN_READER_LOCAL — original reader, extracted from main()
+// RUN_READER_LOCAL — local CBZ reader
 // ==========================================================
 
 void run_reader_local(AppContext *app, const char *filepath) {
-  MangaBook book;
-  if (open_cbz(filepath, &book) != 0) {
+  PageProvider prov;
+  if (provider_open_local(&prov, filepath) != 0) {
     printf("Failed to open %s\n", filepath);
     return;
   }
   strncpy(current_file_path, filepath, 1023);
-  book.mode = detect_mode(filepath);
+  prov.read_mode = detect_mode(filepath);
 
-  if (book.mode == MODE_MANHWA) {
+  if (prov.read_mode == MODE_MANHWA) {
     view_mode = VIEW_MANHWA;
     manhwa_scale = SCALE_FIT_HEIGHT;
   } else {
     view_mode = VIEW_SINGLE;
   }
 
-  int saved = load_bookmark(filepath);
-  if (saved > 0 && saved < book.count)
-    book.current_index = saved;
+  double offset = 0;
+  int saved = load_bookmark(filepath, &offset);
+  if (saved > 0 && saved < prov.count)
+    prov.current_index = saved;
+  reset_view();
+  if (prov.current_index == saved)
+    resume_strip(&prov, app, offset);
 
-  refresh_page(&book, app);
+  refresh_page(&prov, app);
+  app->dirty = 1;
 
   int running = 1;
   SDL_Event e;
@@ -226,33 +454,36 @@ void run_reader_local(AppContext *app, const char *filepath) {
 
   while (running) {
 
-    // --- Continuous Scroll Logic ---
-    if (view_mode == VIEW_MANHWA && !prompt_next) {
-      int curr_h = get_scaled_height(app, 0, manhwa_scale);
-      if (curr_h > 0 && scroll_y >= curr_h) {
-        if (book.current_index < book.count - 1) {
-          book.current_index++;
-          scroll_y -= curr_h;
-          refresh_page(&book, app);
-        }
-      } else if (scroll_y < 0) {
-        if (book.current_index > 0) {
-          int prev_h = get_scaled_height(app, -1, manhwa_scale);
-          book.current_index--;
-          scroll_y += prev_h;
-          refresh_page(&book, app);
-        } else {
-          scroll_y = 0;
-        }
-      }
-    }
+    if (decode_pool_drain(&app->decode_pool) > 0)
+      app->dirty = 1;
+    sync_page_sizes(&prov, app);
+    // Window resized or view changed: decode the pages again at the new size
+    if (update_decode_size(app, view_mode, manhwa_scale))
+      show_pages(&prov, app);
+    if (view_mode == VIEW_MANHWA)
+      update_strip(&prov, app);
+    update_scrubber(&prov, app);
 
-    while (SDL_PollEvent(&e)) {
+    // --- Continuous Scroll Logic ---
+    if (view_mode == VIEW_MANHWA && !prompt_next && settle_strip(&prov, app))
+      refresh_page(&prov, app);
+
+    // Navigation only moves current_index; the page it ends on is loaded
+    // once all pending events are in, so key repeat and fast flipping
+    // don't load every page on the way
+    int nav = 0;
+    for (int have = next_event(app, &e); have; have = SDL_PollEvent(&e)) {
+      if (event_redraws(app, &e))
+        app->dirty = 1;
       if (e.type == SDL_QUIT)
         running = 0;
-      else if (e.type == SDL_MOUSEWHEEL && view_mode == VIEW_MANHWA &&
-               !input_mode && !show_help && !prompt_next) {
+      else if (app->scrubber.open) {
+        if (scrubber_event(&prov, app, &e))
+          nav = 1;
+      } else if (e.type == SDL_MOUSEWHEEL && view_mode == VIEW_MANHWA &&
+                 !input_mode && !show_help && !prompt_next) {
         scroll_y -= e.wheel.y * SCROLL_STEP;
+        note_scroll(&prov, app, -e.wheel.y * SCROLL_STEP);
       } else if (show_help) {
         if (e.type == SDL_KEYDOWN &&
             (e.key.keysym.sym == SDLK_h || e.key.keysym.sym == SDLK_ESCAPE))
@@ -264,10 +495,10 @@ void run_reader_local(AppContext *app, const char *filepath) {
         } else if (e.type == SDL_KEYDOWN) {
           if (e.key.keysym.sym == SDLK_RETURN) {
             int p = atoi(input_buf);
-            if (p > 0 && p <= book.count) {
-              book.current_index = p - 1;
+            if (p > 0 && p <= prov.count) {
+              prov.current_index = p - 1;
               reset_view();
-              refresh_page(&book, app);
+              nav = 1;
             }
             input_mode = 0;
             SDL_StopTextInput();
@@ -288,16 +519,20 @@ void run_reader_local(AppContext *app, const char *filepath) {
           int shift = SDL_GetModState() & KMOD_SHIFT;
           int step =
               (view_mode == VIEW_SINGLE || view_mode == VIEW_MANHWA) ? 1 : 2;
-          int left_is_next = (book.mode == MODE_MANGA);
+          int left_is_next = (prov.read_mode == MODE_MANGA);
 
           switch (e.key.keysym.sym) {
           case SDLK_DOWN:
-            if (view_mode == VIEW_MANHWA)
+            if (view_mode == VIEW_MANHWA) {
               scroll_y += SCROLL_STEP;
+              note_scroll(&prov, app, SCROLL_STEP);
+            }
             break;
           case SDLK_UP:
-            if (view_mode == VIEW_MANHWA)
+            if (view_mode == VIEW_MANHWA) {
               scroll_y -= SCROLL_STEP;
+              note_scroll(&prov, app, -SCROLL_STEP);
+            }
             break;
 
           case SDLK_LEFT:
@@ -305,22 +540,22 @@ void run_reader_local(AppContext *app, const char *filepath) {
               if (prompt_next == 1) {
                 if (get_neighbor_file(current_file_path, 1, next_file_path,
                                       1024)) {
-                  load_new_file(&book, app, next_file_path);
-                  refresh_page(&book, app);
+                  load_new_file(&prov, app, next_file_path);
+                  refresh_page(&prov, app);
                 }
               } else if (prompt_next == -1) {
                 prompt_next = 0;
               } else {
-                if (book.current_index + step >= book.count) {
+                if (prov.current_index + step >= prov.count) {
                   if (get_neighbor_file(current_file_path, 1, next_file_path,
                                         1024))
                     prompt_next = 1;
                   else {
-                    book.current_index = book.count - 1;
+                    prov.current_index = prov.count - 1;
                     changed = 1;
                   }
                 } else {
-                  book.current_index += step;
+                  prov.current_index += step;
                   changed = 1;
                 }
               }
@@ -328,20 +563,20 @@ void run_reader_local(AppContext *app, const char *filepath) {
               if (prompt_next == -1) {
                 if (get_neighbor_file(current_file_path, -1, next_file_path,
                                       1024)) {
-                  load_new_file(&book, app, next_file_path);
-                  refresh_page(&book, app);
+                  load_new_file(&prov, app, next_file_path);
+                  refresh_page(&prov, app);
                 }
               } else if (prompt_next == 1) {
                 prompt_next = 0;
               } else {
-                if (book.current_index == 0) {
+                if (prov.current_index == 0) {
                   if (get_neighbor_file(current_file_path, -1, next_file_path,
                                         1024))
                     prompt_next = -1;
                 } else {
-                  book.current_index -= step;
-                  if (book.current_index < 0)
-                    book.current_index = 0;
+                  prov.current_index -= step;
+                  if (prov.current_index < 0)
+                    prov.current_index = 0;
                   changed = 1;
                 }
               }
@@ -353,22 +588,22 @@ void run_reader_local(AppContext *app, const char *filepath) {
               if (prompt_next == 1) {
                 if (get_neighbor_file(current_file_path, 1, next_file_path,
                                       1024)) {
-                  load_new_file(&book, app, next_file_path);
-                  refresh_page(&book, app);
+                  load_new_file(&prov, app, next_file_path);
+                  refresh_page(&prov, app);
                 }
               } else if (prompt_next == -1) {
                 prompt_next = 0;
               } else {
-                if (book.current_index + step >= book.count) {
+                if (prov.current_index + step >= prov.count) {
                   if (get_neighbor_file(current_file_path, 1, next_file_path,
                                         1024))
                     prompt_next = 1;
                   else {
-                    book.current_index = book.count - 1;
+                    prov.current_index = prov.count - 1;
                     changed = 1;
                   }
                 } else {
-                  book.current_index += step;
+                  prov.current_index += step;
                   changed = 1;
                 }
               }
@@ -376,20 +611,20 @@ void run_reader_local(AppContext *app, const char *filepath) {
               if (prompt_next == -1) {
                 if (get_neighbor_file(current_file_path, -1, next_file_path,
                                       1024)) {
-                  load_new_file(&book, app, next_file_path);
-                  refresh_page(&book, app);
+                  load_new_file(&prov, app, next_file_path);
+                  refresh_page(&prov, app);
                 }
               } else if (prompt_next == 1) {
                 prompt_next = 0;
               } else {
-                if (book.current_index == 0) {
+                if (prov.current_index == 0) {
                   if (get_neighbor_file(current_file_path, -1, next_file_path,
                                         1024))
                     prompt_next = -1;
                 } else {
-                  book.current_index -= step;
-                  if (book.current_index < 0)
-                    book.current_index = 0;
+                  prov.current_index -= step;
+                  if (prov.current_index < 0)
+                    prov.current_index = 0;
                   changed = 1;
                 }
               }
@@ -397,7 +632,7 @@ void run_reader_local(AppContext *app, const char *filepath) {
             break;
 
           case SDLK_s:
-            if (book.mode == MODE_MANHWA) {
+            if (prov.read_mode == MODE_MANHWA) {
               view_mode = VIEW_MANHWA;
               manhwa_scale = SCALE_FIT_HEIGHT;
               reset_view();
@@ -408,7 +643,7 @@ void run_reader_local(AppContext *app, const char *filepath) {
             break;
 
           case SDLK_d:
-            if (book.mode == MODE_MANHWA) {
+            if (prov.read_mode == MODE_MANHWA) {
               if (!shift) {
                 view_mode = VIEW_MANHWA;
                 manhwa_scale = SCALE_FIT_WIDTH;
@@ -427,13 +662,15 @@ void run_reader_local(AppContext *app, const char *filepath) {
             break;
 
           case SDLK_b:
-            book.current_index = 0;
+            prov.current_index = 0;
             reset_view();
             changed = 1;
             break;
           case SDLK_e:
-            book.current_index = book.count - 1;
+            prov.current_index = prov.count - 1;
             reset_view();
+            if (view_mode == VIEW_MANHWA)
+              strip_jump_end(&prov, app);
             changed = 1;
             break;
           case SDLK_f:
@@ -447,6 +684,9 @@ void run_reader_local(AppContext *app, const char *filepath) {
           case SDLK_h:
             show_help = !show_help;
             break;
+          case SDLK_t:
+            scrubber_open(&app->scrubber, prov.current_index, prov.count);
+            break;
           case SDLK_ESCAPE:
             if (SDL_GetWindowFlags(app->window) & SDL_WINDOW_FULLSCREEN_DESKTOP)
               SDL_SetWindowFullscreen(app->window, 0);
@@ -456,22 +696,28 @@ void run_reader_local(AppContext *app, const char *filepath) {
           }
 
           // --- ALIGNMENT CORRECTION ---
-          if ((view_mode == VIEW_DOUBLE_COVER) && book.current_index > 0 &&
-              book.current_index % 2 == 0) {
-            book.current_index--;
+          if ((view_mode == VIEW_DOUBLE_COVER) && prov.current_index > 0 &&
+              prov.current_index % 2 == 0) {
+            prov.current_index--;
           } else if (view_mode == VIEW_DOUBLE &&
-                     book.current_index % 2 != 0) {
-            book.current_index--;
+                     prov.current_index % 2 != 0) {
+            prov.current_index--;
           }
 
           if (changed)
-            refresh_page(&book, app);
+            nav = 1;
         }
       }
     }
+    if (view_mode == VIEW_MANHWA && !prompt_next && settle_strip(&prov, app))
+      nav = 1;
+    if (nav)
+      refresh_page(&prov, app);
 
-    snprintf(overlay, 32, "%d / %d", book.current_index + 1, book.count);
-    PageDir p_dir = (book.mode == MODE_MANGA) ? DIR_MANGA : DIR_COMIC;
+    if (!app->dirty)
+      continue;
+    snprintf(overlay, 32, "%d / %d", prov.current_index + 1, prov.count);
+    PageDir p_dir = (prov.read_mode == MODE_MANGA) ? DIR_MANGA : DIR_COMIC;
 
     const char *popup_msg = NULL;
     if (prompt_next == 1)
@@ -480,12 +726,15 @@ void run_reader_local(AppContext *app, const char *filepath) {
       popup_msg = "Start of Volume. Press Back again to go back.";
 
     render_frame(app, overlay, input_mode ? input_buf : NULL, view_mode,
-                 manhwa_scale, p_dir, show_help, scroll_y, book.mode,
+                 manhwa_scale, p_dir, show_help, scroll_y, prov.read_mode,
                  popup_msg);
   }
 
-  save_bookmark(current_file_path, book.current_index);
-  close_cbz(&book);
+  save_bookmark(current_file_path, prov.current_index,
+                page_offset(&prov, app));
+  provider_close(&prov);
+  clear_slots(app);
+  scrubber_reset(&app->scrubber);
 }
 
 // ==========================================================
@@ -502,7 +751,9 @@ void run_reader_komga(AppContext *app, KomgaClient *client,
 
   // Sync bookmark: pick higher of Komga progress vs local
   int local_page = 0, local_completed = 0;
-  if (load_komga_progress(book_id, &local_page, &local_completed) == 0) {
+  double local_offset = 0;
+  if (load_komga_progress(book_id, &local_page, &local_completed,
+                          &local_offset) == 0) {
     if (local_page > prov.current_index && local_page < prov.count)
       prov.current_index = local_page;
   }
@@ -514,8 +765,11 @@ void run_reader_komga(AppContext *app, KomgaClient *client,
     view_mode = VIEW_SINGLE;
   }
   reset_view();
+  if (prov.current_index == local_page)
+    resume_strip(&prov, app, local_offset);
 
   refresh_page_komga(&prov, app);
+  app->dirty = 1;
 
   int running = 1;
   SDL_Event e;
@@ -528,35 +782,42 @@ void run_reader_komga(AppContext *app, KomgaClient *client,
 
   while (running) {
 
+    if (decode_pool_drain(&app->decode_pool) > 0)
+      app->dirty = 1;
+    sync_page_sizes(&prov, app);
+    // Pick up pages that landed since (and follow resizes and the strip);
+    // pages only ever loaded are left alone
+    show_pages(&prov, app);
+    update_scrubber(&prov, app);
+
     // --- Continuous Scroll Logic (Manhwa) ---
     if (view_mode == VIEW_MANHWA && !komga_prompt_next) {
-      int curr_h = get_scaled_height(app, 0, manhwa_scale);
-      if (curr_h > 0 && scroll_y >= curr_h) {
-        if (prov.current_index < prov.count - 1) {
-          prov.current_index++;
-          scroll_y -= curr_h;
-          refresh_page_komga(&prov, app);
-          save_komga_progress(book_id, prov.current_index, 0);
-          pages_since_sync++;
-        }
-      } else if (scroll_y < 0) {
-        if (prov.current_index > 0) {
-          int prev_h = get_scaled_height(app, -1, manhwa_scale);
-          prov.current_index--;
-          scroll_y += prev_h;
-          refresh_page_komga(&prov, app);
-        } else {
-          scroll_y = 0;
-        }
+      int moved = settle_strip(&prov, app);
+      if (moved != 0)
+        refresh_page_komga(&prov, app);
+      if (moved > 0) {
+        save_komga_progress(book_id, prov.current_index, 0,
+                            page_offset(&prov, app));
+        pages_since_sync += moved;
       }
     }
 
-    while (SDL_PollEvent(&e)) {
+    // Navigation only moves current_index; the page it ends on is loaded
+    // once all pending events are in, so key repeat and fast flipping
+    // don't load every page on the way
+    int nav = 0;
+    for (int have = next_event(app, &e); have; have = SDL_PollEvent(&e)) {
+      if (event_redraws(app, &e))
+        app->dirty = 1;
       if (e.type == SDL_QUIT) {
         running = 0;
+      } else if (app->scrubber.open) {
+        if (scrubber_event(&prov, app, &e))
+          nav = 1;
       } else if (e.type == SDL_MOUSEWHEEL && view_mode == VIEW_MANHWA &&
                  !input_mode && !show_help && !komga_prompt_next) {
         scroll_y -= e.wheel.y * SCROLL_STEP;
+        note_scroll(&prov, app, -e.wheel.y * SCROLL_STEP);
       } else if (show_help) {
         if (e.type == SDL_KEYDOWN &&
             (e.key.keysym.sym == SDLK_h || e.key.keysym.sym == SDLK_ESCAPE))
@@ -571,7 +832,7 @@ void run_reader_komga(AppContext *app, KomgaClient *client,
             if (p > 0 && p <= prov.count) {
               prov.current_index = p - 1;
               reset_view();
-              refresh_page_komga(&prov, app);
+              nav = 1;
             }
             input_mode = 0;
             SDL_StopTextInput();
@@ -595,12 +856,16 @@ void run_reader_komga(AppContext *app, KomgaClient *client,
 
           switch (e.key.keysym.sym) {
           case SDLK_DOWN:
-            if (view_mode == VIEW_MANHWA)
+            if (view_mode == VIEW_MANHWA) {
               scroll_y += SCROLL_STEP;
+              note_scroll(&prov, app, SCROLL_STEP);
+            }
             break;
           case SDLK_UP:
-            if (view_mode == VIEW_MANHWA)
+            if (view_mode == VIEW_MANHWA) {
               scroll_y -= SCROLL_STEP;
+              note_scroll(&prov, app, -SCROLL_STEP);
+            }
             break;
 
           case SDLK_LEFT:
@@ -614,8 +879,11 @@ void run_reader_komga(AppContext *app, KomgaClient *client,
                   int completed = (prov.current_index >= prov.count - 1);
                   komga_update_read_progress(client, book_id,
                                              prov.current_index + 1, completed);
-                  save_komga_progress(book_id, prov.current_index, completed);
+                  save_komga_progress(book_id, prov.current_index, completed,
+                                      page_offset(&prov, app));
                   provider_close(&prov);
+                  clear_slots(app);
+                  scrubber_reset(&app->scrubber);
                   if (provider_open_komga(&prov, client, next_book.id, mode) ==
                       0) {
                     strncpy((char *)book_id, next_book.id, 63);
@@ -651,8 +919,11 @@ void run_reader_komga(AppContext *app, KomgaClient *client,
                 if (komga_get_prev_book(client, book_id, &prev_book) == 0) {
                   komga_update_read_progress(client, book_id,
                                              prov.current_index + 1, 0);
-                  save_komga_progress(book_id, prov.current_index, 0);
+                  save_komga_progress(book_id, prov.current_index, 0,
+                                      page_offset(&prov, app));
                   provider_close(&prov);
+                  clear_slots(app);
+                  scrubber_reset(&app->scrubber);
                   if (provider_open_komga(&prov, client, prev_book.id, mode) ==
                       0) {
                     strncpy((char *)book_id, prev_book.id, 63);
@@ -691,8 +962,11 @@ void run_reader_komga(AppContext *app, KomgaClient *client,
                   int completed = (prov.current_index >= prov.count - 1);
                   komga_update_read_progress(client, book_id,
                                              prov.current_index + 1, completed);
-                  save_komga_progress(book_id, prov.current_index, completed);
+                  save_komga_progress(book_id, prov.current_index, completed,
+                                      page_offset(&prov, app));
                   provider_close(&prov);
+                  clear_slots(app);
+                  scrubber_reset(&app->scrubber);
                   if (provider_open_komga(&prov, client, next_book.id, mode) ==
                       0) {
                     strncpy((char *)book_id, next_book.id, 63);
@@ -728,8 +1002,11 @@ void run_reader_komga(AppContext *app, KomgaClient *client,
                 if (komga_get_prev_book(client, book_id, &prev_book) == 0) {
                   komga_update_read_progress(client, book_id,
                                              prov.current_index + 1, 0);
-                  save_komga_progress(book_id, prov.current_index, 0);
+                  save_komga_progress(book_id, prov.current_index, 0,
+                                      page_offset(&prov, app));
                   provider_close(&prov);
+                  clear_slots(app);
+                  scrubber_reset(&app->scrubber);
                   if (provider_open_komga(&prov, client, prev_book.id, mode) ==
                       0) {
                     strncpy((char *)book_id, prev_book.id, 63);
@@ -797,6 +1074,8 @@ void run_reader_komga(AppContext *app, KomgaClient *client,
           case SDLK_e:
             prov.current_index = prov.count - 1;
             reset_view();
+            if (view_mode == VIEW_MANHWA)
+              strip_jump_end(&prov, app);
             changed = 1;
             break;
           case SDLK_f:
@@ -810,6 +1089,9 @@ void run_reader_komga(AppContext *app, KomgaClient *client,
           case SDLK_h:
             show_help = !show_help;
             break;
+          case SDLK_t:
+            scrubber_open(&app->scrubber, prov.current_index, prov.count);
+            break;
           case SDLK_ESCAPE:
             if (SDL_GetWindowFlags(app->window) & SDL_WINDOW_FULLSCREEN_DESKTOP)
               SDL_SetWindowFullscreen(app->window, 0);
@@ -827,20 +1109,28 @@ void run_reader_komga(AppContext *app, KomgaClient *client,
             prov.current_index--;
           }
 
-          if (changed) {
-            refresh_page_komga(&prov, app);
-            save_komga_progress(book_id, prov.current_index, 0);
-            pages_since_sync++;
-            if (pages_since_sync >= 5) {
-              komga_update_read_progress(client, book_id,
-                                         prov.current_index + 1, 0);
-              pages_since_sync = 0;
-            }
-          }
+          if (changed)
+            nav = 1;
         }
       }
     }
+    if (view_mode == VIEW_MANHWA && !komga_prompt_next &&
+        settle_strip(&prov, app))
+      nav = 1;
+    if (nav) {
+      refresh_page_komga(&prov, app);
+      save_komga_progress(book_id, prov.current_index, 0,
+                          page_offset(&prov, app));
+      pages_since_sync++;
+      if (pages_since_sync >= 5) {
+        komga_update_read_progress(client, book_id, prov.current_index + 1,
+                                   0);
+        pages_since_sync = 0;
+      }
+    }
 
+    if (!app->dirty)
+      continue;
     snprintf(overlay, 32, "%d / %d", prov.current_index + 1, prov.count);
     PageDir p_dir = (mode == MODE_MANGA) ? DIR_MANGA : DIR_COMIC;
 
@@ -858,9 +1148,11 @@ void run_reader_komga(AppContext *app, KomgaClient *client,
   int completed = (prov.current_index >= prov.count - 1);
   komga_update_read_progress(client, book_id, prov.current_index + 1,
                              completed);
-  save_komga_progress(book_id, prov.current_index, completed);
+  save_komga_progress(book_id, prov.current_index, completed,
+                      page_offset(&prov, app));
   provider_close(&prov);
   clear_slots(app);
+  scrubber_reset(&app->scrubber);
 }
 
 // ==========================================================
@@ -899,21 +1191,24 @@ void run_browser(AppContext *app, AppConfig *config) {
 
   if (browser_load_libraries(&state, &client) != 0) {
     printf("Failed to load libraries from Komga\n");
-    browser_cleanup(&state, app->renderer);
+    browser_cleanup(&state, app);
     komga_cleanup(&client);
     return;
   }
 
   // Load first library's series
-  browser_load_series(&state, &client, app->renderer, 0);
+  browser_load_series(&state, &client, app, 0);
 
   SDL_SetWindowTitle(app->window, "Manga Reader - Library Browser");
 
   int running = 1;
   SDL_Event e;
+  app->dirty = 1;
 
   while (running) {
-    while (SDL_PollEvent(&e)) {
+    for (int have = next_event(app, &e); have; have = SDL_PollEvent(&e)) {
+      if (event_redraws(app, &e))
+        app->dirty = 1;
       if (e.type == SDL_QUIT) {
         running = 0;
         break;
@@ -977,13 +1272,13 @@ void run_browser(AppContext *app, AppConfig *config) {
       }
     }
 
-    if (running)
+    if (decode_pool_drain(&app->decode_pool) > 0)
+      app->dirty = 1;
+    if (running && app->dirty)
       browser_render(&state, app);
-
-    SDL_Delay(16); // ~60fps
   }
 
-  browser_cleanup(&state, app->renderer);
+  browser_cleanup(&state, app);
   komga_cleanup(&client);
 }
 
@@ -991,6 +1286,17 @@ void run_browser(AppContext *app, AppConfig *config) {
 // MAIN — entry point dispatcher
 // ==========================================================
 
+// Page decoding for the provider's worker threads
+static void *decode_hook(const char *data, size_t size, int max_w,
+                         int max_h) {
+  return decode_page(data, size, max_w, max_h);
+}
+
+static void free_hook(void *image) { SDL_FreeSurface((SDL_Surface *)image); }
+
+// Pages landing in the provider wake the idle event loop
+static void wake_hook(void *user) { decode_pool_wake((DecodePool *)user); }
+
 int main(int argc, char *argv[]) {
   if (init_bookmarks_db() != 0)
     return 1;
@@ -998,6 +1304,8 @@ int main(int argc, char *argv[]) {
   AppConfig config;
   config_set_defaults(&config);
   config_load(&config); // OK if it fails
+  provider_configure(&config);
+  provider_set_decoder(decode_hook, free_hook);
 
   // Check for --book <id> flag
   const char *komga_book_id = NULL;
@@ -1013,6 +1321,9 @@ int main(int argc, char *argv[]) {
     close_bookmarks_db();
     return 1;
   }
+  app.strip_margin = config.strip_margin;
+  app.upload_budget = (size_t)config.upload_budget_mb * 1024 * 1024;
+  provider_set_wakeup(wake_hook, &app.decode_pool);
 
   if (komga_book_id && config_has_komga(&config)) {
     // Direct Komga book mode
@@ -0,0 +1,52 @@
+#include "page_buffer.h"
+#include <stdlib.h>
+
+PageBuffer *page_buffer_wrap(char *data, size_t size) {
+  if (!data)
+    return NULL;
+
+  PageBuffer *buf = malloc(sizeof(PageBuffer));
+  if (!buf) {
+    free(data);
+    return NULL;
+  }
+  atomic_init(&buf->refs, 1);
+  buf->size = size;
+  buf->data = data;
+  buf->release = NULL;
+  buf->owner = NULL;
+  return buf;
+}
+
+PageBuffer *page_buffer_borrow(const char *data, size_t size,
+                               void (*release)(void *owner), void *owner) {
+  PageBuffer *buf = malloc(sizeof(PageBuffer));
+  if (!buf) {
+    release(owner);
+    return NULL;
+  }
+  atomic_init(&buf->refs, 1);
+  buf->size = size;
+  buf->data = data;
+  buf->release = release;
+  buf->owner = owner;
+  return buf;
+}
+
+PageBuffer *page_buffer_retain(PageBuffer *buf) {
+  if (buf)
+    atomic_fetch_add_explicit(&buf->refs, 1, memory_order_relaxed);
+  return buf;
+}
+
+void page_buffer_release(PageBuffer *buf) {
+  if (!buf)
+    return;
+  if (atomic_fetch_sub_explicit(&buf->refs, 1, memory_order_acq_rel) == 1) {
+    if (buf->release)
+      buf->release(buf->owner);
+    else
+      free((void *)buf->data);
+    free(buf);
+  }
+}
@@ -0,0 +1,166 @@
+#include "page_cache.h"
+#include <stdlib.h>
+#include <string.h>
+
+// --- Internal helpers ---
+
+// Higher rank = evicted sooner. Pages behind the reader (relative to the
+// current reading direction) go before pages ahead of it; within each side
+// the page furthest from the reader goes first.
+static long eviction_rank(const PageCache *c, int index) {
+  long dist = (long)(index - c->position) * c->direction;
+  if (dist < 0)
+    return (long)c->page_count - dist;
+  return dist;
+}
+
+// The page with the highest rank. Ranks fall towards the reader on both
+// sides, so it is one end of the resident list: the end behind the reader
+// while any page lies behind, the far end ahead otherwise.
+static CachedPage *pick_victim(const PageCache *c) {
+  CachedPage *behind = c->direction > 0 ? c->head : c->tail;
+  CachedPage *ahead = c->direction > 0 ? c->tail : c->head;
+  if (behind && eviction_rank(c, behind->index) > c->page_count)
+    return behind;
+  return ahead;
+}
+
+static void unlink_entry(PageCache *c, CachedPage *e) {
+  if (e->prev)
+    e->prev->next = e->next;
+  else
+    c->head = e->next;
+  if (e->next)
+    e->next->prev = e->prev;
+  else
+    c->tail = e->prev;
+
+  c->slots[e->index] = NULL;
+  c->bytes_used -= e->buf->size;
+  c->entry_count--;
+}
+
+// Put e into the resident list in page order
+static void link_entry(PageCache *c, CachedPage *e) {
+  CachedPage *prev = NULL;
+  if (c->tail && c->tail->index < e->index) {
+    prev = c->tail;
+  } else if (c->head && c->head->index < e->index) {
+    for (int i = e->index - 1; !prev; i--)
+      prev = c->slots[i];
+  }
+
+  e->prev = prev;
+  e->next = prev ? prev->next : c->head;
+  if (e->next)
+    e->next->prev = e;
+  else
+    c->tail = e;
+  if (prev)
+    prev->next = e;
+  else
+    c->head = e;
+  c->slots[e->index] = e;
+  c->entry_count++;
+}
+
+static void free_entry(CachedPage *e) {
+  page_buffer_release(e->buf);
+  free(e);
+}
+
+// --- Public API ---
+
+int page_cache_init(PageCache *c, int page_count, size_t budget) {
+  memset(c, 0, sizeof(PageCache));
+  c->budget = budget ? budget : PAGE_CACHE_DEFAULT_BUDGET;
+  c->direction = 1;
+
+  if (page_count <= 0)
+    return 0;
+
+  c->slots = calloc(page_count, sizeof(CachedPage *));
+  if (!c->slots)
+    return -1;
+  c->page_count = page_count;
+  return 0;
+}
+
+void page_cache_free(PageCache *c) {
+  CachedPage *e = c->head;
+  while (e) {
+    CachedPage *next = e->next;
+    free_entry(e);
+    e = next;
+  }
+  free(c->slots);
+  c->slots = NULL;
+  c->head = NULL;
+  c->tail = NULL;
+  c->entry_count = 0;
+  c->bytes_used = 0;
+  c->page_count = 0;
+}
+
+void page_cache_set_position(PageCache *c, int index) {
+  if (index > c->position)
+    c->direction = 1;
+  else if (index < c->position)
+    c->direction = -1;
+  c->position = index;
+}
+
+CachedPage *page_cache_get(PageCache *c, int index) {
+  if (index < 0 || index >= c->page_count || !c->slots[index]) {
+    c->stats.misses++;
+    return NULL;
+  }
+  c->stats.hits++;
+  return c->slots[index];
+}
+
+int page_cache_contains(const PageCache *c, int index) {
+  return index >= 0 && index < c->page_count && c->slots[index] != NULL;
+}
+
+int page_cache_store(PageCache *c, int index, PageBuffer *buf) {
+  if (!buf)
+    return -1;
+  if (index < 0 || index >= c->page_count) {
+    page_buffer_release(buf);
+    return -1;
+  }
+  if (c->slots[index]) {
+    // Already resident (e.g. main thread and prefetch raced for it)
+    page_buffer_release(buf);
+    return 0;
+  }
+
+  // Make room. If every resident page is more useful than the new one,
+  // keep what we have instead.
+  size_t size = buf->size;
+  long rank = eviction_rank(c, index);
+  while (c->entry_count > 0 && c->bytes_used + size > c->budget) {
+    CachedPage *victim = pick_victim(c);
+    if (eviction_rank(c, victim->index) < rank) {
+      page_buffer_release(buf);
+      return -1;
+    }
+    unlink_entry(c, victim);
+    free_entry(victim);
+    c->stats.evictions++;
+  }
+
+  CachedPage *e = malloc(sizeof(CachedPage));
+  if (!e) {
+    page_buffer_release(buf);
+    return -1;
+  }
+  e->index = index;
+  e->buf = buf;
+  link_entry(c, e);
+  c->bytes_used += size;
+  if (c->bytes_used > c->stats.peak_bytes)
+    c->stats.peak_bytes = c->bytes_used;
+  return 0;
+}
@@ -1,122 +1,705 @@
 #include "page_provider.h"
+#include "bookmark_manager.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-// --- Cache helpers (caller must hold cache_mutex for Komga sources) ---
+static size_t cache_budget = PAGE_CACHE_DEFAULT_BUDGET;
+static int fetch_concurrency = 4;
+static PageDecodeFn page_decode = NULL;
+static PageFreeFn page_free = NULL;
+static PageWakeFn page_wake = NULL;
+static void *page_wake_user = NULL;
 
-static void cache_clear(PageProvider *p) {
-  for (int i = 0; i < PAGE_CACHE_SIZE; i++) {
-    if (p->cache[i].data) {
-      free(p->cache[i].data);
-      p->cache[i].data = NULL;
-    }
-    p->cache[i].index = -1;
-    p->cache[i].size = 0;
+// A page finished loading or failed: wake borrowers waiting for it and let
+// the app know. Caller holds cache_mutex.
+static void page_landed(PageProvider *p) {
+  pthread_cond_broadcast(&p->fetch_done);
+  if (page_wake)
+    page_wake(page_wake_user);
+}
+
+// --- Fetch engine (caller holds cache_mutex unless noted) ---
+
+// Read-ahead/read-behind window: the policy's, stretched to cover the span
+// the screen needs
+static int window_ahead(const PageProvider *p) {
+  return p->policy.ahead > p->span_ahead ? p->policy.ahead : p->span_ahead;
+}
+
+static int window_behind(const PageProvider *p) {
+  return p->policy.behind > p->span_behind ? p->policy.behind
+                                           : p->span_behind;
+}
+
+// Pages within this window around the reader are worth downloading
+static int fetch_relevant(const PageProvider *p, int index) {
+  return index >= p->current_index - window_behind(p) - 2 &&
+         index <= p->current_index + window_ahead(p) + 2;
+}
+
+static void track_position(PageProvider *p) {
+  page_cache_set_position(&p->cache, p->current_index);
+  prefetch_policy_note_position(&p->policy, p->current_index);
+}
+
+static FetchSlot *slot_for_page(PageProvider *p, int index) {
+  for (int i = 0; i < FETCH_SLOT_COUNT; i++) {
+    FetchSlot *slot = &p->fetch_slots[i];
+    if (slot->index == index && !slot->preview &&
+        !atomic_load(&slot->cancel))
+      return slot;
   }
+  return NULL;
 }
 
-static CachedPage *cache_find(PageProvider *p, int index) {
-  for (int i = 0; i < PAGE_CACHE_SIZE; i++) {
-    if (p->cache[i].index == index && p->cache[i].data)
-      return &p->cache[i];
+static FetchRequest *queued_request(PageProvider *p, int index) {
+  for (int i = 0; i < FETCH_QUEUE_SIZE; i++) {
+    if (p->fetch_queue[i].index == index)
+      return &p->fetch_queue[i];
   }
   return NULL;
 }
 
-static void cache_store(PageProvider *p, int index, const char *data,
-                        size_t size) {
-  // Find an empty slot or the slot furthest from current_index
-  int best = 0;
-  int best_dist = -1;
+static int fetch_pending(PageProvider *p, int index) {
+  return slot_for_page(p, index) || queued_request(p, index);
+}
 
-  for (int i = 0; i < PAGE_CACHE_SIZE; i++) {
-    if (!p->cache[i].data) {
-      best = i;
+// Returns 1 if the request is new, 0 if it was already cached, downloading
+// or queued (its priority is raised if needed), or not worth queueing
+static int enqueue_fetch(PageProvider *p, int index, FetchPriority priority) {
+  if (page_cache_contains(&p->cache, index) ||
+      p->remote_pages[index].failed_at == p->current_index)
+    return 0;
+
+  // Already downloading or queued: just raise its priority
+  FetchSlot *slot = slot_for_page(p, index);
+  if (slot) {
+    if (priority < slot->priority)
+      slot->priority = priority;
+    return 0;
+  }
+  FetchRequest *req = queued_request(p, index);
+  if (req) {
+    if (priority < req->priority)
+      req->priority = priority;
+    return 0;
+  }
+
+  // Take a free entry, or bump the least important one
+  FetchRequest *victim = NULL;
+  for (int i = 0; i < FETCH_QUEUE_SIZE; i++) {
+    FetchRequest *r = &p->fetch_queue[i];
+    if (r->index < 0) {
+      victim = r;
       break;
     }
-    int dist = abs(p->cache[i].index - p->current_index);
-    if (dist > best_dist) {
-      best_dist = dist;
-      best = i;
-    }
+    if (!victim || r->priority > victim->priority)
+      victim = r;
   }
+  if (victim->index >= 0 && victim->priority < priority)
+    return 0;
+  victim->index = index;
+  victim->priority = priority;
+  return 1;
+}
 
-  if (p->cache[best].data)
-    free(p->cache[best].data);
+// Highest priority queued request, nearest to the reader on ties
+static FetchRequest *next_request(PageProvider *p) {
+  FetchRequest *best = NULL;
+  for (int i = 0; i < FETCH_QUEUE_SIZE; i++) {
+    FetchRequest *r = &p->fetch_queue[i];
+    if (r->index < 0)
+      continue;
+    if (!best || r->priority < best->priority ||
+        (r->priority == best->priority &&
+         abs(r->index - p->current_index) <
+             abs(best->index - p->current_index)))
+      best = r;
+  }
+  return best;
+}
 
-  p->cache[best].index = index;
-  p->cache[best].size = size;
-  p->cache[best].data = malloc(size);
-  if (p->cache[best].data)
-    memcpy(p->cache[best].data, data, size);
+static int wants_prefetch(PageProvider *p, int index) {
+  return index >= 0 && index < p->count &&
+         !page_cache_contains(&p->cache, index) && !fetch_pending(p, index) &&
+         p->remote_pages[index].failed_at != p->current_index;
 }
 
-// --- Prefetch thread ---
+// Next page around the reader that is neither cached nor downloading:
+// the window ahead first, then the (usually smaller) window behind.
+static int next_prefetch_target(PageProvider *p) {
+  for (int i = 1; i <= window_ahead(p); i++) {
+    if (wants_prefetch(p, p->current_index + i))
+      return p->current_index + i;
+  }
+  for (int i = 1; i <= window_behind(p); i++) {
+    if (wants_prefetch(p, p->current_index - i))
+      return p->current_index - i;
+  }
+  return -1;
+}
+
+// Drop queued requests and abort downloads the reader has moved away from.
+// Aborting happens in fetch_progress() on the engine thread.
+static void cancel_stale_fetches(PageProvider *p) {
+  for (int i = 0; i < FETCH_QUEUE_SIZE; i++) {
+    FetchRequest *r = &p->fetch_queue[i];
+    if (r->index >= 0 && !fetch_relevant(p, r->index))
+      r->index = -1;
+  }
+  for (int i = 0; i < FETCH_SLOT_COUNT; i++) {
+    FetchSlot *slot = &p->fetch_slots[i];
+    if (slot->index >= 0 && !fetch_relevant(p, slot->index))
+      atomic_store(&slot->cancel, 1);
+  }
+}
+
+static int fetch_progress(void *clientp, curl_off_t dltotal, curl_off_t dlnow,
+                          curl_off_t ultotal, curl_off_t ulnow) {
+  FetchSlot *slot = (FetchSlot *)clientp;
+  return atomic_load(&slot->cancel); // non-zero aborts the transfer
+}
+
+static int start_fetch(PageProvider *p, FetchSlot *slot, int index,
+                       FetchPriority priority, int preview) {
+  int begun = preview ? komga_transfer_begin_page_thumbnail(
+                            &p->prefetch_client, &slot->xfer, p->book_id,
+                            index + 1)
+                      : komga_transfer_begin_page(&p->prefetch_client,
+                                                  &slot->xfer, p->book_id,
+                                                  index + 1);
+  if (begun != 0)
+    return -1;
+  curl_easy_setopt(slot->xfer.easy, CURLOPT_PRIVATE, slot);
+  curl_easy_setopt(slot->xfer.easy, CURLOPT_XFERINFOFUNCTION, fetch_progress);
+  curl_easy_setopt(slot->xfer.easy, CURLOPT_XFERINFODATA, slot);
+  curl_easy_setopt(slot->xfer.easy, CURLOPT_NOPROGRESS, 0L);
+  atomic_store(&slot->cancel, 0);
+  slot->index = index;
+  slot->preview = preview;
+  slot->priority = priority;
+  curl_multi_add_handle(p->multi, slot->xfer.easy);
+  return 0;
+}
+
+// Hand idle slots to a wanted thumbnail first, then to queued requests,
+// then to read-ahead. Read-ahead never takes the reserved slots, so a
+// visible page (and its thumbnail) start immediately. Returns the number of
+// transfers in flight.
+static int start_fetches(PageProvider *p) {
+  int active = 0;
+  for (int i = 0; i < FETCH_SLOT_COUNT; i++) {
+    if (p->fetch_slots[i].index >= 0)
+      active++;
+  }
+
+  for (int i = 0; i < p->max_connections + FETCH_RESERVED_SLOTS; i++) {
+    FetchSlot *slot = &p->fetch_slots[i];
+    if (slot->index >= 0)
+      continue;
+
+    int wanted = p->preview_wanted;
+    p->preview_wanted = -1;
+    if (wanted >= 0 && fetch_relevant(p, wanted) &&
+        !page_cache_contains(&p->cache, wanted) &&
+        start_fetch(p, slot, wanted, FETCH_VISIBLE, 1) == 0) {
+      active++;
+      continue;
+    }
+
+    FetchRequest *req = next_request(p);
+    if (req) {
+      int index = req->index;
+      FetchPriority priority = req->priority;
+      req->index = -1;
+      if (page_cache_contains(&p->cache, index) ||
+          start_fetch(p, slot, index, priority, 0) != 0) {
+        page_landed(p);
+        continue;
+      }
+      active++;
+      continue;
+    }
+
+    if (active >= p->max_connections)
+      break;
+    int target = next_prefetch_target(p);
+    if (target < 0)
+      break;
+    if (start_fetch(p, slot, target, FETCH_SPECULATIVE, 0) == 0)
+      active++;
+  }
+  return active;
+}
+
+// Collect finished downloads into the cache. Called without the lock.
+static void finish_fetches(PageProvider *p) {
+  CURLMsg *msg;
+  int pending;
+  while ((msg = curl_multi_info_read(p->multi, &pending))) {
+    if (msg->msg != CURLMSG_DONE)
+      continue;
+
+    CURL *easy = msg->easy_handle;
+    CURLcode result = msg->data.result;
+    FetchSlot *slot = NULL;
+    curl_easy_getinfo(easy, CURLINFO_PRIVATE, (char **)&slot);
+    curl_multi_remove_handle(p->multi, easy);
+
+    size_t size = 0;
+    char *data = komga_transfer_finish(&slot->xfer, result, &size);
+    curl_off_t elapsed_us = 0;
+    if (data)
+      curl_easy_getinfo(easy, CURLINFO_TOTAL_TIME_T, &elapsed_us);
+    PageBuffer *buf = NULL;
+    if (data && size > 0)
+      buf = page_buffer_wrap(data, size);
+    else
+      free(data);
+
+    pthread_mutex_lock(&p->cache_mutex);
+    int target = slot->index;
+    slot->index = -1;
+    RemotePage *rp = &p->remote_pages[target];
+
+    if (slot->preview) {
+      // Worth keeping only until the page itself is there
+      if (buf && !rp->preview && !page_cache_contains(&p->cache, target))
+        rp->preview = buf;
+      else
+        page_buffer_release(buf);
+      page_landed(p);
+      pthread_mutex_unlock(&p->cache_mutex);
+      continue;
+    }
+
+    if (buf)
+      prefetch_policy_note_download(&p->policy, size, elapsed_us / 1e6);
+    else if (!atomic_load(&slot->cancel))
+      rp->failed_at = p->current_index;
+
+    // Store only if still relevant (user hasn't jumped far away). The cache
+    // takes over our reference, so nothing is copied under the lock.
+    if (buf) {
+      if (fetch_relevant(p, target)) {
+        page_cache_store(&p->cache, target, buf);
+        page_buffer_release(rp->preview);
+        rp->preview = NULL;
+      } else {
+        page_buffer_release(buf);
+      }
+    }
+    page_landed(p);
+    pthread_mutex_unlock(&p->cache_mutex);
+  }
+}
 
 static void *prefetch_thread_func(void *arg) {
   PageProvider *p = (PageProvider *)arg;
 
   pthread_mutex_lock(&p->cache_mutex);
   while (p->prefetch_running) {
-    int base = p->current_index;
-
-    // Find the next uncached page ahead of current
-    int target = -1;
-    for (int i = 1; i <= PREFETCH_AHEAD; i++) {
-      int idx = base + i;
-      if (idx >= p->count)
-        break;
-      if (!cache_find(p, idx)) {
-        target = idx;
-        break;
+    track_position(p);
+    prefetch_policy_update(&p->policy, p->cache.budget);
+    cancel_stale_fetches(p);
+
+    if (start_fetches(p) == 0) {
+      // Nothing requested and everything ahead is cached, wait for signal
+      pthread_cond_wait(&p->prefetch_cond, &p->cache_mutex);
+      continue;
+    }
+
+    // Release lock while the transfers make progress. The poll returns early
+    // on socket activity or when a request or position change wakes us.
+    pthread_mutex_unlock(&p->cache_mutex);
+
+    int still_running = 0;
+    curl_multi_perform(p->multi, &still_running);
+    finish_fetches(p);
+    if (still_running)
+      curl_multi_poll(p->multi, NULL, 0, 1000, NULL);
+
+    pthread_mutex_lock(&p->cache_mutex);
+  }
+  pthread_cond_broadcast(&p->fetch_done);
+  pthread_mutex_unlock(&p->cache_mutex);
+
+  // Abandon whatever is still downloading
+  for (int i = 0; i < FETCH_SLOT_COUNT; i++) {
+    FetchSlot *slot = &p->fetch_slots[i];
+    if (slot->index >= 0)
+      curl_multi_remove_handle(p->multi, slot->xfer.easy);
+    slot->index = -1;
+    komga_transfer_cleanup(&slot->xfer);
+  }
+  return NULL;
+}
+
+// --- Local pipeline (caller holds cache_mutex unless noted) ---
+
+// Pages this close to the reader are kept decoded. The window leans in the
+// reading direction, so paging backwards decodes the pages behind.
+static int decode_wanted(const PageProvider *p, int index) {
+  int offset = (index - p->current_index) * p->cache.direction;
+  return offset >= -LOCAL_DECODE_BEHIND && offset <= LOCAL_DECODE_AHEAD;
+}
+
+// Whether the page's decoded image is there and of the current decode size
+static int image_ready(const PageProvider *p, const LocalPage *lp) {
+  return lp->image && lp->size_gen == p->decode_gen;
+}
+
+// Free decoded pages the reader has moved away from, or that were decoded
+// for another size. Failures are forgotten once the page is out of reach,
+// so it is retried if the reader comes back.
+static void drop_distant_pages(PageProvider *p) {
+  for (int i = 0; i < p->count; i++) {
+    LocalPage *lp = &p->local_pages[i];
+    int wanted = decode_wanted(p, i);
+    if (lp->image && lp->pins == 0 && (!wanted || !image_ready(p, lp))) {
+      page_free(lp->image);
+      lp->image = NULL;
+    }
+    if (wanted)
+      continue;
+    if (!fetch_relevant(p, i)) {
+      lp->failed = 0;
+      lp->no_room = 0;
+    }
+  }
+}
+
+static int local_idle(const PageProvider *p, int index) {
+  const LocalPage *lp = &p->local_pages[index];
+  return !lp->busy && !lp->failed;
+}
+
+// Next job for a worker: decode the pages nearest the reader first (current,
+// next, previous, then further ahead), then read the bytes of the rest of
+// the prefetch window into the cache. Returns -1 when there is nothing to do.
+static int next_local_task(PageProvider *p, int *decode) {
+  static const int decode_order[] = {0, 1, -1, 2, 3};
+  if (page_decode) {
+    for (int i = 0; i < (int)(sizeof(decode_order) / sizeof(int)); i++) {
+      int index = p->current_index + decode_order[i] * p->cache.direction;
+      if (index < 0 || index >= p->count || !decode_wanted(p, index))
+        continue;
+      if (!p->local_pages[index].image && local_idle(p, index)) {
+        *decode = 1;
+        return index;
       }
     }
+  }
 
-    if (target < 0) {
-      // Everything ahead is cached, wait for signal
+  *decode = 0;
+  for (int i = 0; i <= window_ahead(p); i++) {
+    int index = p->current_index + i;
+    if (index < p->count && !page_cache_contains(&p->cache, index) &&
+        local_idle(p, index) && !p->local_pages[index].no_room)
+      return index;
+  }
+  for (int i = 1; i <= window_behind(p); i++) {
+    int index = p->current_index - i;
+    if (index >= 0 && !page_cache_contains(&p->cache, index) &&
+        local_idle(p, index) && !p->local_pages[index].no_room)
+      return index;
+  }
+  return -1;
+}
+
+static void *local_worker_func(void *arg) {
+  PageProvider *p = (PageProvider *)arg;
+
+  pthread_mutex_lock(&p->cache_mutex);
+  while (p->prefetch_running) {
+    track_position(p);
+    prefetch_policy_update(&p->policy, p->cache.budget);
+    drop_distant_pages(p);
+
+    int decode = 0;
+    int index = next_local_task(p, &decode);
+    if (index < 0) {
       pthread_cond_wait(&p->prefetch_cond, &p->cache_mutex);
       continue;
     }
 
-    // Release lock during network fetch
+    LocalPage *lp = &p->local_pages[index];
+    lp->busy = 1;
+    int max_w = p->decode_w, max_h = p->decode_h;
+    unsigned size_gen = p->decode_gen;
+    PageBuffer *buf = page_cache_contains(&p->cache, index)
+                          ? page_buffer_retain(p->cache.slots[index]->buf)
+                          : NULL;
     pthread_mutex_unlock(&p->cache_mutex);
 
-    size_t size = 0;
-    char *data =
-        komga_get_page(&p->prefetch_client, p->book_id, target + 1, &size);
+    // Read and decode without the lock
+    int fresh = 0;
+    if (!buf) {
+      buf = borrow_page_data(&p->local_book, index);
+      fresh = buf != NULL;
+    }
+    void *image = (buf && decode)
+                      ? page_decode(buf->data, buf->size, max_w, max_h)
+                      : NULL;
 
     pthread_mutex_lock(&p->cache_mutex);
-
-    // Store only if still relevant (user hasn't jumped far away)
-    if (data && size > 0) {
-      if (abs(target - p->current_index) <= PREFETCH_AHEAD + 2 &&
-          !cache_find(p, target)) {
-        cache_store(p, target, data, size);
+    lp->busy = 0;
+    if (!buf || (decode && !image))
+      lp->failed = 1;
+    if (fresh && (!fetch_relevant(p, index) ||
+                  page_cache_store(&p->cache, index,
+                                   page_buffer_retain(buf)) != 0))
+      lp->no_room = 1;
+    page_buffer_release(buf);
+    if (image) {
+      if (decode_wanted(p, index) && size_gen == p->decode_gen && !lp->image) {
+        lp->image = image;
+        lp->size_gen = size_gen;
+      } else {
+        page_free(image);
       }
     }
-    if (data)
-      free(data);
+    page_landed(p);
   }
   pthread_mutex_unlock(&p->cache_mutex);
   return NULL;
 }
 
+// --- Side thread: scrubber thumbnails and page sizes (caller holds
+// cache_mutex unless noted) ---
+
+// Wanted thumbnail nearest the scrubber, -1 if there is none
+static int next_thumbnail(const PageProvider *p) {
+  if (!p->thumb_state)
+    return -1;
+  int best = -1;
+  for (int i = 0; i < p->count; i++) {
+    if (p->thumb_state[i] != THUMB_WANTED)
+      continue;
+    if (best < 0 || abs(i - p->thumb_focus) < abs(best - p->thumb_focus))
+      best = i;
+  }
+  return best;
+}
+
+// First page whose size is still unknown, -1 once all are measured
+static int next_probe(PageProvider *p) {
+  while (p->probe_cursor < p->count && p->probed_sizes[p->probe_cursor].w != 0)
+    p->probe_cursor++;
+  return p->probe_cursor < p->count ? p->probe_cursor : -1;
+}
+
+// Decode the thumbnail of page index; drops cache_mutex meanwhile
+static void make_thumbnail(PageProvider *p, int index) {
+  p->thumb_state[index] = THUMB_BUSY;
+  int max_w = p->thumb_w, max_h = p->thumb_h;
+  // Bytes already at hand save the read: the page itself for local books,
+  // or the thumbnail a page jump fetched for Komga ones
+  PageBuffer *buf = NULL;
+  if (p->type == SOURCE_LOCAL_CBZ && page_cache_contains(&p->cache, index))
+    buf = page_buffer_retain(p->cache.slots[index]->buf);
+  else if (p->remote_pages && p->remote_pages[index].preview)
+    buf = page_buffer_retain(p->remote_pages[index].preview);
+  pthread_mutex_unlock(&p->cache_mutex);
+
+  if (!buf) {
+    if (p->type == SOURCE_LOCAL_CBZ) {
+      buf = borrow_page_data(&p->local_book, index);
+    } else {
+      size_t size = 0;
+      char *data = komga_get_page_thumbnail(&p->side_client, p->book_id,
+                                            index + 1, &size);
+      if (data && size > 0)
+        buf = page_buffer_wrap(data, size);
+      else
+        free(data);
+    }
+  }
+  void *image = buf ? page_decode(buf->data, buf->size, max_w, max_h) : NULL;
+  page_buffer_release(buf);
+
+  pthread_mutex_lock(&p->cache_mutex);
+  p->thumbs[index] = image;
+  p->thumb_state[index] = image ? THUMB_READY : THUMB_FAILED;
+  page_landed(p);
+}
+
+// Read the size of page index from its header; drops cache_mutex meanwhile
+static void measure_page(PageProvider *p, int index) {
+  pthread_mutex_unlock(&p->cache_mutex);
+  PageSize size = {0, 0};
+  int rc = -1;
+  if (p->type == SOURCE_LOCAL_CBZ) {
+    rc = probe_page_size(&p->local_book, index, &size);
+  } else {
+    size_t n = 0;
+    char *head = komga_get_page_head(&p->side_client, p->book_id, index + 1,
+                                     PROBE_HEAD_BYTES, &n);
+    if (head)
+      rc = probe_image_size((const unsigned char *)head, n, &size);
+    free(head);
+  }
+
+  pthread_mutex_lock(&p->cache_mutex);
+  p->probed_sizes[index] = rc == 0 ? size : (PageSize){-1, -1};
+  p->sizes_changed = 1;
+  p->sizes_measured = 1;
+  // Let the app relayout in batches rather than once per page
+  if (++p->probes_since_wake >= PROBE_WAKE_BATCH || next_probe(p) < 0) {
+    p->probes_since_wake = 0;
+    if (page_wake)
+      page_wake(page_wake_user);
+  }
+}
+
+static void *side_thread_func(void *arg) {
+  PageProvider *p = (PageProvider *)arg;
+
+  // Thumbnails first, someone is looking at the scrubber; page sizes with
+  // whatever time is left
+  pthread_mutex_lock(&p->cache_mutex);
+  while (p->side_running) {
+    int index = next_thumbnail(p);
+    if (index >= 0) {
+      make_thumbnail(p, index);
+      continue;
+    }
+    index = next_probe(p);
+    if (index >= 0) {
+      measure_page(p, index);
+      continue;
+    }
+    pthread_cond_wait(&p->side_cond, &p->cache_mutex);
+  }
+  pthread_mutex_unlock(&p->cache_mutex);
+  return NULL;
+}
+
+// Start the side thread if it isn't running. Main thread only, without
+// cache_mutex held. Returns 0 when it runs.
+static int start_side_thread(PageProvider *p) {
+  if (p->side_running)
+    return 0;
+  if (p->side_failed || p->count <= 0)
+    return -1;
+
+  p->side_failed = 1; // until it is up
+  if (p->type == SOURCE_KOMGA_STREAM &&
+      komga_init(&p->side_client, p->client->base_url, p->client->api_key,
+                 p->client->username, p->client->password) != 0) {
+    komga_cleanup(&p->side_client);
+    return -1;
+  }
+  p->side_running = 1;
+  if (pthread_create(&p->side_thread, NULL, side_thread_func, p) != 0) {
+    p->side_running = 0;
+    if (p->type == SOURCE_KOMGA_STREAM)
+      komga_cleanup(&p->side_client);
+    return -1;
+  }
+  p->side_failed = 0;
+  return 0;
+}
+
+// Allocate the size tables, seeded with the sizes known already (none if
+// known is NULL). Pages still unknown are left to the side thread.
+static void init_page_sizes(PageProvider *p, const PageSize *known) {
+  p->page_sizes = calloc(p->count > 0 ? p->count : 1, sizeof(PageSize));
+  p->probed_sizes = calloc(p->count > 0 ? p->count : 1, sizeof(PageSize));
+  if (!p->page_sizes || !p->probed_sizes) {
+    free(p->page_sizes);
+    free(p->probed_sizes);
+    p->page_sizes = p->probed_sizes = NULL;
+    return;
+  }
+  if (known) {
+    memcpy(p->page_sizes, known, p->count * sizeof(PageSize));
+    memcpy(p->probed_sizes, known, p->count * sizeof(PageSize));
+  }
+  if (next_probe(p) >= 0)
+    start_side_thread(p);
+}
+
+// Wake the background threads whether they sleep on the condition or in
+// curl_multi_poll. Caller holds cache_mutex.
+static void wake_engine(PageProvider *p) {
+  pthread_cond_broadcast(&p->prefetch_cond);
+  if (p->multi)
+    curl_multi_wakeup(p->multi);
+}
+
+static void init_sync(PageProvider *p) {
+  pthread_mutex_init(&p->cache_mutex, NULL);
+  pthread_cond_init(&p->prefetch_cond, NULL);
+  pthread_cond_init(&p->fetch_done, NULL);
+  pthread_cond_init(&p->side_cond, NULL);
+  p->prefetch_running = 0;
+}
+
 // --- Public API ---
 
+void provider_configure(const AppConfig *cfg) {
+  if (cfg->cache_budget_mb > 0)
+    cache_budget = (size_t)cfg->cache_budget_mb * 1024 * 1024;
+  if (cfg->prefetch_connections > 0)
+    fetch_concurrency = cfg->prefetch_connections < PREFETCH_MAX_CONNECTIONS
+                            ? cfg->prefetch_connections
+                            : PREFETCH_MAX_CONNECTIONS;
+}
+
+void provider_set_decoder(PageDecodeFn decode, PageFreeFn free_image) {
+  page_decode = decode;
+  page_free = free_image;
+}
+
+void provider_set_wakeup(PageWakeFn wake, void *user) {
+  page_wake = wake;
+  page_wake_user = user;
+}
+
 int provider_open_local(PageProvider *p, const char *cbz_path) {
   memset(p, 0, sizeof(PageProvider));
   p->type = SOURCE_LOCAL_CBZ;
 
-  for (int i = 0; i < PAGE_CACHE_SIZE; i++)
-    p->cache[i].index = -1;
-
   if (open_cbz(cbz_path, &p->local_book) != 0)
     return -1;
 
   p->count = p->local_book.count;
   p->current_index = p->local_book.current_index;
   p->read_mode = p->local_book.mode;
+
+  // Everything the threads touch exists before any of them starts
+  p->local_pages = calloc(p->count > 0 ? p->count : 1, sizeof(LocalPage));
+  if (!p->local_pages ||
+      page_cache_init(&p->cache, p->count, cache_budget) != 0) {
+    fprintf(stderr, "Failed to allocate page cache for %s\n", cbz_path);
+    free(p->local_pages);
+    p->local_pages = NULL;
+    close_cbz(&p->local_book);
+    return -1;
+  }
+  prefetch_policy_init(&p->policy, p->current_index);
+  init_sync(p);
+
+  // The page index remembers sizes measured on earlier visits
+  PageSize *known = calloc(p->count > 0 ? p->count : 1, sizeof(PageSize));
+  if (known) {
+    for (int i = 0; i < p->count; i++)
+      known[i] = (PageSize){p->local_book.pages[i].width,
+                            p->local_book.pages[i].height};
+  }
+  init_page_sizes(p, known);
+  free(known);
+
+  p->prefetch_running = 1;
+  for (int i = 0; i < LOCAL_WORKERS; i++) {
+    if (pthread_create(&p->local_workers[i], NULL, local_worker_func, p) != 0)
+      break;
+    p->worker_count++;
+  }
+  if (p->worker_count == 0)
+    p->prefetch_running = 0;
   return 0;
 }
 
@@ -128,9 +711,6 @@ int provider_open_komga(PageProvider *p, KomgaClient *client,
   strncpy(p->book_id, book_id, sizeof(p->book_id) - 1);
   p->read_mode = mode;
 
-  for (int i = 0; i < PAGE_CACHE_SIZE; i++)
-    p->cache[i].index = -1;
-
   // Fetch book details to get page count and read progress
   KomgaBook details;
   if (komga_get_book_details(client, book_id, &details) != 0) {
@@ -147,85 +727,427 @@ int provider_open_komga(PageProvider *p, KomgaClient *client,
     p->current_index = details.read_progress_page;
   }
 
-  // Initialize synchronization primitives
-  pthread_mutex_init(&p->cache_mutex, NULL);
-  pthread_cond_init(&p->prefetch_cond, NULL);
-  p->prefetch_running = 0;
+  if (page_cache_init(&p->cache, p->count, cache_budget) != 0) {
+    fprintf(stderr, "Failed to allocate page cache for %s\n", book_id);
+    return -1;
+  }
+  p->remote_pages = calloc(p->count > 0 ? p->count : 1, sizeof(RemotePage));
+  if (!p->remote_pages) {
+    page_cache_free(&p->cache);
+    return -1;
+  }
+  for (int i = 0; i < p->count; i++)
+    p->remote_pages[i].failed_at = -1;
+  p->preview_wanted = -1;
+  prefetch_policy_init(&p->policy, p->current_index);
+  init_sync(p);
+
+  // The prefetch thread runs its own multi handle with several page
+  // downloads in flight, multiplexed over HTTP/2 when the server allows it.
+  p->max_connections = fetch_concurrency;
+  for (int i = 0; i < FETCH_SLOT_COUNT; i++) {
+    p->fetch_slots[i].index = -1;
+    atomic_init(&p->fetch_slots[i].cancel, 0);
+  }
+  for (int i = 0; i < FETCH_QUEUE_SIZE; i++)
+    p->fetch_queue[i].index = -1;
 
-  // Create a separate KomgaClient for the prefetch thread (own curl handle)
   if (komga_init(&p->prefetch_client, client->base_url, client->api_key,
-                 client->username, client->password) == 0) {
+                 client->username, client->password) == 0 &&
+      (p->multi = curl_multi_init()) != NULL) {
+    curl_multi_setopt(p->multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(p->multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+                      (long)(p->max_connections + FETCH_RESERVED_SLOTS));
     p->prefetch_running = 1;
-    pthread_create(&p->prefetch_thread, NULL, prefetch_thread_func, p);
+    if (pthread_create(&p->prefetch_thread, NULL, prefetch_thread_func, p) !=
+        0) {
+      p->prefetch_running = 0;
+      curl_multi_cleanup(p->multi);
+      p->multi = NULL; // wake_engine() checks it
+      komga_cleanup(&p->prefetch_client);
+      fprintf(stderr, "Warning: prefetch thread disabled (no thread)\n");
+    }
   } else {
     fprintf(stderr, "Warning: prefetch thread disabled (curl init failed)\n");
+    komga_cleanup(&p->prefetch_client);
   }
 
+  // Sizes from an earlier visit, else from Komga's page list; pages it
+  // hasn't analysed are measured in the background
+  PageSize *known = calloc(p->count > 0 ? p->count : 1, sizeof(PageSize));
+  if (known && load_komga_page_sizes(book_id, known, p->count) < p->count &&
+      komga_get_page_sizes(client, book_id, known, p->count) == 0)
+    save_komga_page_sizes(book_id, known, p->count);
+  init_page_sizes(p, known);
+  free(known);
+
   return 0;
 }
 
-char *provider_get_page(PageProvider *p, int index, size_t *out_size) {
-  if (index < 0 || index >= p->count) {
-    *out_size = 0;
+PageBuffer *provider_borrow_page(PageProvider *p, int index) {
+  if (index < 0 || index >= p->count)
     return NULL;
+
+  // Check cache first (under lock)
+  pthread_mutex_lock(&p->cache_mutex);
+  track_position(p);
+  CachedPage *cached = page_cache_get(&p->cache, index);
+  if (cached) {
+    PageBuffer *buf = page_buffer_retain(cached->buf);
+    pthread_mutex_unlock(&p->cache_mutex);
+    return buf;
   }
 
   if (p->type == SOURCE_LOCAL_CBZ) {
-    int saved = p->local_book.current_index;
-    p->local_book.current_index = index;
-    char *data = get_image_data(&p->local_book, out_size);
-    p->local_book.current_index = saved;
-    return data;
+    // A worker already reading it will be done sooner than a second read
+    if (p->local_pages) {
+      while (p->local_pages[index].busy)
+        pthread_cond_wait(&p->fetch_done, &p->cache_mutex);
+      if (page_cache_contains(&p->cache, index)) {
+        PageBuffer *buf = page_buffer_retain(p->cache.slots[index]->buf);
+        pthread_mutex_unlock(&p->cache_mutex);
+        return buf;
+      }
+    }
+    wake_engine(p);
+    pthread_mutex_unlock(&p->cache_mutex);
+
+    PageBuffer *buf = borrow_page_data(&p->local_book, index);
+    if (buf) {
+      pthread_mutex_lock(&p->cache_mutex);
+      page_cache_store(&p->cache, index, page_buffer_retain(buf));
+      pthread_mutex_unlock(&p->cache_mutex);
+    }
+    return buf;
   }
 
-  // SOURCE_KOMGA_STREAM — check cache first (under lock)
+  // Cache miss — let the engine fetch it ahead of read-ahead and wait
+  if (p->prefetch_running) {
+    enqueue_fetch(p, index,
+                  index == p->current_index ? FETCH_VISIBLE : FETCH_ADJACENT);
+    wake_engine(p);
+    while (p->prefetch_running && !page_cache_contains(&p->cache, index) &&
+           fetch_pending(p, index))
+      pthread_cond_wait(&p->fetch_done, &p->cache_mutex);
+
+    PageBuffer *buf = page_cache_contains(&p->cache, index)
+                          ? page_buffer_retain(p->cache.slots[index]->buf)
+                          : NULL;
+    pthread_mutex_unlock(&p->cache_mutex);
+    return buf;
+  }
+  pthread_mutex_unlock(&p->cache_mutex);
+
+  // No engine — fetch from Komga (blocking, uses main thread's client)
+  size_t size = 0;
+  char *data = komga_get_page(p->client, p->book_id, index + 1, &size);
+  if (!data || size == 0) {
+    free(data);
+    return NULL;
+  }
+
+  PageBuffer *buf = page_buffer_wrap(data, size);
+  if (buf) {
+    pthread_mutex_lock(&p->cache_mutex);
+    page_cache_store(&p->cache, index, page_buffer_retain(buf));
+    pthread_mutex_unlock(&p->cache_mutex);
+  }
+  return buf;
+}
+
+void provider_release_page(PageBuffer *buf) { page_buffer_release(buf); }
+
+PageBuffer *provider_try_borrow_page(PageProvider *p, int index) {
+  if (index < 0 || index >= p->count)
+    return NULL;
+
   pthread_mutex_lock(&p->cache_mutex);
-  CachedPage *cached = cache_find(p, index);
-  if (cached) {
-    char *copy = malloc(cached->size);
-    if (copy) {
-      memcpy(copy, cached->data, cached->size);
-      *out_size = cached->size;
+  PageBuffer *buf = NULL;
+  if (page_cache_contains(&p->cache, index)) {
+    buf = page_buffer_retain(page_cache_get(&p->cache, index)->buf);
+  } else if (p->type == SOURCE_KOMGA_STREAM) {
+    if (p->prefetch_running && enqueue_fetch(p, index, FETCH_ADJACENT))
+      wake_engine(p);
+  } else if (p->local_pages && local_idle(p, index) &&
+             !p->local_pages[index].no_room) {
+    wake_engine(p); // the span keeps it inside the workers' window
+  }
+  pthread_mutex_unlock(&p->cache_mutex);
+  return buf;
+}
+
+PageBuffer *provider_borrow_preview(PageProvider *p, int index) {
+  if (p->type != SOURCE_KOMGA_STREAM || !p->prefetch_running || index < 0 ||
+      index >= p->count)
+    return NULL;
+
+  pthread_mutex_lock(&p->cache_mutex);
+  PageBuffer *buf = NULL;
+  RemotePage *rp = &p->remote_pages[index];
+  if (!page_cache_contains(&p->cache, index)) {
+    int requested = enqueue_fetch(p, index,
+                                  index == p->current_index ? FETCH_VISIBLE
+                                                            : FETCH_ADJACENT);
+    if (rp->preview) {
+      buf = page_buffer_retain(rp->preview);
+    } else if (!rp->preview_requested && rp->failed_at != p->current_index) {
+      rp->preview_requested = 1;
+      p->preview_wanted = index;
+      requested = 1;
     }
-    pthread_mutex_unlock(&p->cache_mutex);
-    return copy;
+    if (requested)
+      wake_engine(p);
+  }
+  pthread_mutex_unlock(&p->cache_mutex);
+  return buf;
+}
+
+void *provider_borrow_decoded(PageProvider *p, int index, int wait) {
+  if (p->type != SOURCE_LOCAL_CBZ || !p->local_pages || index < 0 ||
+      index >= p->count)
+    return NULL;
+
+  pthread_mutex_lock(&p->cache_mutex);
+  track_position(p);
+  wake_engine(p);
+  LocalPage *lp = &p->local_pages[index];
+  while (wait && lp->busy && !image_ready(p, lp))
+    pthread_cond_wait(&p->fetch_done, &p->cache_mutex);
+
+  void *image = image_ready(p, lp) ? lp->image : NULL;
+  if (image)
+    lp->pins++;
+  pthread_mutex_unlock(&p->cache_mutex);
+  return image;
+}
+
+void provider_release_decoded(PageProvider *p, int index) {
+  if (p->type != SOURCE_LOCAL_CBZ || !p->local_pages || index < 0 ||
+      index >= p->count)
+    return;
+
+  pthread_mutex_lock(&p->cache_mutex);
+  if (p->local_pages[index].pins > 0)
+    p->local_pages[index].pins--;
+  pthread_mutex_unlock(&p->cache_mutex);
+}
+
+char *provider_get_page(PageProvider *p, int index, size_t *out_size) {
+  *out_size = 0;
+  PageBuffer *buf = provider_borrow_page(p, index);
+  if (!buf)
+    return NULL;
+
+  char *copy = malloc(buf->size);
+  if (copy) {
+    memcpy(copy, buf->data, buf->size);
+    *out_size = buf->size;
+  }
+  page_buffer_release(buf);
+  return copy;
+}
+
+int provider_sync_sizes(PageProvider *p) {
+  if (!p->page_sizes)
+    return 0;
+  pthread_mutex_lock(&p->cache_mutex);
+  int changed = p->sizes_changed;
+  if (changed) {
+    memcpy(p->page_sizes, p->probed_sizes, p->count * sizeof(PageSize));
+    p->sizes_changed = 0;
   }
   pthread_mutex_unlock(&p->cache_mutex);
+  return changed;
+}
+
+void provider_request_page(PageProvider *p, int index,
+                           FetchPriority priority) {
+  if (p->type != SOURCE_KOMGA_STREAM || !p->prefetch_running || index < 0 ||
+      index >= p->count)
+    return;
+  pthread_mutex_lock(&p->cache_mutex);
+  enqueue_fetch(p, index, priority);
+  wake_engine(p);
+  pthread_mutex_unlock(&p->cache_mutex);
+}
 
-  // Cache miss — fetch from Komga (blocking, uses main thread's client)
-  char *data = komga_get_page(p->client, p->book_id, index + 1, out_size);
-  if (data && *out_size > 0) {
+void provider_want_thumbnail(PageProvider *p, int index, int max_w,
+                             int max_h) {
+  if (!page_decode || index < 0 || index >= p->count)
+    return;
+  if (!p->thumb_state) {
+    unsigned char *state = calloc(p->count, 1);
+    void **thumbs = calloc(p->count, sizeof(void *));
+    if (!state || !thumbs || start_side_thread(p) != 0) {
+      free(state);
+      free(thumbs);
+      return;
+    }
     pthread_mutex_lock(&p->cache_mutex);
-    if (!cache_find(p, index))
-      cache_store(p, index, data, *out_size);
+    p->thumb_state = state;
+    p->thumbs = thumbs;
     pthread_mutex_unlock(&p->cache_mutex);
   }
 
-  return data;
+  pthread_mutex_lock(&p->cache_mutex);
+  p->thumb_w = max_w;
+  p->thumb_h = max_h;
+  if (p->thumb_state[index] == THUMB_NONE) {
+    p->thumb_state[index] = THUMB_WANTED;
+    pthread_cond_signal(&p->side_cond);
+  }
+  pthread_mutex_unlock(&p->cache_mutex);
+}
+
+void provider_focus_thumbnails(PageProvider *p, int first, int last,
+                               int focus) {
+  if (!p->thumb_state)
+    return;
+  pthread_mutex_lock(&p->cache_mutex);
+  p->thumb_focus = focus;
+  for (int i = 0; i < p->count; i++) {
+    if (p->thumb_state[i] == THUMB_WANTED && (i < first || i > last))
+      p->thumb_state[i] = THUMB_NONE;
+  }
+  pthread_mutex_unlock(&p->cache_mutex);
+}
+
+void *provider_take_thumbnail(PageProvider *p, int index) {
+  if (!p->thumb_state || index < 0 || index >= p->count)
+    return NULL;
+  void *image = NULL;
+  pthread_mutex_lock(&p->cache_mutex);
+  if (p->thumb_state[index] == THUMB_READY) {
+    image = p->thumbs[index];
+    p->thumbs[index] = NULL;
+    p->thumb_state[index] = THUMB_NONE;
+  }
+  pthread_mutex_unlock(&p->cache_mutex);
+  return image;
 }
 
 void provider_notify_prefetch(PageProvider *p) {
-  if (p->type != SOURCE_KOMGA_STREAM || !p->prefetch_running)
+  if (!p->prefetch_running)
     return;
-  pthread_cond_signal(&p->prefetch_cond);
+  pthread_mutex_lock(&p->cache_mutex);
+  wake_engine(p);
+  pthread_mutex_unlock(&p->cache_mutex);
+}
+
+void provider_note_scroll(PageProvider *p, double pages) {
+  pthread_mutex_lock(&p->cache_mutex);
+  prefetch_policy_note_scroll(&p->policy, pages);
+  pthread_mutex_unlock(&p->cache_mutex);
+}
+
+void provider_set_span(PageProvider *p, int behind, int ahead) {
+  pthread_mutex_lock(&p->cache_mutex);
+  int grew = ahead > p->span_ahead || behind > p->span_behind;
+  p->span_ahead = ahead;
+  p->span_behind = behind;
+  if (grew && p->prefetch_running)
+    wake_engine(p);
+  pthread_mutex_unlock(&p->cache_mutex);
+}
+
+void provider_set_decode_size(PageProvider *p, int max_w, int max_h) {
+  pthread_mutex_lock(&p->cache_mutex);
+  if (max_w != p->decode_w || max_h != p->decode_h) {
+    p->decode_w = max_w;
+    p->decode_h = max_h;
+    p->decode_gen++;
+    if (p->prefetch_running)
+      wake_engine(p);
+  }
+  pthread_mutex_unlock(&p->cache_mutex);
+}
+
+void provider_prefetch_window(PageProvider *p, int *ahead, int *behind) {
+  pthread_mutex_lock(&p->cache_mutex);
+  *ahead = p->policy.ahead;
+  *behind = p->policy.behind;
+  pthread_mutex_unlock(&p->cache_mutex);
+}
+
+PageCacheStats provider_cache_stats(PageProvider *p) {
+  pthread_mutex_lock(&p->cache_mutex);
+  PageCacheStats stats = p->cache.stats;
+  pthread_mutex_unlock(&p->cache_mutex);
+  return stats;
 }
 
 void provider_close(PageProvider *p) {
-  // Stop prefetch thread if running
-  if (p->type == SOURCE_KOMGA_STREAM) {
-    if (p->prefetch_running) {
-      pthread_mutex_lock(&p->cache_mutex);
-      p->prefetch_running = 0;
-      pthread_cond_signal(&p->prefetch_cond);
-      pthread_mutex_unlock(&p->cache_mutex);
+  // Stop background threads if running
+  if (p->prefetch_running) {
+    pthread_mutex_lock(&p->cache_mutex);
+    p->prefetch_running = 0;
+    wake_engine(p);
+    pthread_mutex_unlock(&p->cache_mutex);
+
+    if (p->type == SOURCE_KOMGA_STREAM) {
       pthread_join(p->prefetch_thread, NULL);
+      curl_multi_cleanup(p->multi);
       komga_cleanup(&p->prefetch_client);
+    } else {
+      for (int i = 0; i < p->worker_count; i++)
+        pthread_join(p->local_workers[i], NULL);
+    }
+  }
+  if (p->side_running) {
+    pthread_mutex_lock(&p->cache_mutex);
+    p->side_running = 0;
+    pthread_cond_signal(&p->side_cond);
+    pthread_mutex_unlock(&p->cache_mutex);
+    pthread_join(p->side_thread, NULL);
+    if (p->type == SOURCE_KOMGA_STREAM)
+      komga_cleanup(&p->side_client);
+  }
+
+  // Keep what was measured for the next visit
+  if (p->sizes_measured) {
+    if (p->type == SOURCE_LOCAL_CBZ)
+      save_page_sizes(p->local_book.path, p->probed_sizes, p->count);
+    else
+      save_komga_page_sizes(p->book_id, p->probed_sizes, p->count);
+  }
+  free(p->page_sizes);
+  free(p->probed_sizes);
+  pthread_mutex_destroy(&p->cache_mutex);
+  pthread_cond_destroy(&p->prefetch_cond);
+  pthread_cond_destroy(&p->fetch_done);
+  pthread_cond_destroy(&p->side_cond);
+
+  if (p->local_pages) {
+    for (int i = 0; i < p->count; i++) {
+      if (p->local_pages[i].image)
+        page_free(p->local_pages[i].image);
     }
-    pthread_mutex_destroy(&p->cache_mutex);
-    pthread_cond_destroy(&p->prefetch_cond);
+    free(p->local_pages);
+  }
+  if (p->remote_pages) {
+    for (int i = 0; i < p->count; i++)
+      page_buffer_release(p->remote_pages[i].preview);
+    free(p->remote_pages);
   }
+  if (p->thumbs) {
+    for (int i = 0; i < p->count; i++) {
+      if (p->thumbs[i])
+        page_free(p->thumbs[i]);
+    }
+    free(p->thumbs);
+  }
+  free(p->thumb_state);
 
-  cache_clear(p);
+  if (p->cache.stats.hits + p->cache.stats.misses > 0) {
+    printf("Page cache: %lu hits, %lu misses, %lu evictions, peak %zu KB "
+           "(budget %zu KB)\n",
+           p->cache.stats.hits, p->cache.stats.misses, p->cache.stats.evictions,
+           p->cache.stats.peak_bytes / 1024, p->cache.budget / 1024);
+    printf("Prefetch window: %d ahead, %d behind (%.1fs/page, %.0f KB/s)\n",
+           p->policy.ahead, p->policy.behind, p->policy.dwell_ema,
+           p->policy.throughput_ema / 1024);
+  }
+  page_cache_free(&p->cache);
 
   if (p->type == SOURCE_LOCAL_CBZ)
     close_cbz(&p->local_book);
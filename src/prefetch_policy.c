@@ -0,0 +1,120 @@
+#include "prefetch_policy.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PREFETCH_DEFAULT_AHEAD 5
+#define PREFETCH_HORIZON 3.0 // seconds of reading to keep ready
+
+double prefetch_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void prefetch_policy_init(PrefetchPolicy *pp, int start_index) {
+  memset(pp, 0, sizeof(PrefetchPolicy));
+  pp->last_index = start_index;
+  pp->last_move_time = prefetch_now();
+  pp->dwell_ema = 1.0;
+  pp->ahead = PREFETCH_DEFAULT_AHEAD;
+  pp->behind = 1;
+}
+
+void prefetch_policy_note_position(PrefetchPolicy *pp, int index) {
+  int moved = index - pp->last_index;
+  if (moved == 0)
+    return;
+
+  double now = prefetch_now();
+  double dt = now - pp->last_move_time;
+
+  // Only ordinary page turns say something about reading speed; jumps and
+  // long breaks do not.
+  if (abs(moved) <= 2 && dt < 120.0) {
+    pp->dwell_ema = pp->dwell_ema * 0.7 + (dt / abs(moved)) * 0.3;
+    pp->backward_ema = pp->backward_ema * 0.8 + (moved < 0 ? 0.2 : 0.0);
+  }
+
+  pp->last_index = index;
+  pp->last_move_time = now;
+}
+
+void prefetch_policy_note_scroll(PrefetchPolicy *pp, double pages) {
+  double now = prefetch_now();
+
+  // A pause starts a new burst
+  if (now - pp->last_scroll_time > 1.0) {
+    pp->scroll_accum = 0;
+    pp->scroll_sample_time = now;
+  }
+  pp->last_scroll_time = now;
+  pp->scroll_accum += fabs(pages);
+
+  double dt = now - pp->scroll_sample_time;
+  if (dt >= 0.25) {
+    pp->scroll_rate_ema = pp->scroll_rate_ema * 0.6 + (pp->scroll_accum / dt) * 0.4;
+    pp->scroll_accum = 0;
+    pp->scroll_sample_time = now;
+  }
+}
+
+void prefetch_policy_note_download(PrefetchPolicy *pp, size_t bytes,
+                                   double seconds) {
+  if (bytes == 0)
+    return;
+  if (pp->page_size_ema == 0)
+    pp->page_size_ema = bytes;
+  else
+    pp->page_size_ema = pp->page_size_ema * 0.8 + bytes * 0.2;
+
+  if (seconds <= 0.0005)
+    return;
+  double rate = bytes / seconds;
+  if (pp->throughput_ema == 0)
+    pp->throughput_ema = rate;
+  else
+    pp->throughput_ema = pp->throughput_ema * 0.7 + rate * 0.3;
+}
+
+void prefetch_policy_update(PrefetchPolicy *pp, size_t cache_budget) {
+  double now = prefetch_now();
+
+  // How fast is the reader moving through pages right now?
+  double pages_per_sec = pp->dwell_ema > 0.05 ? 1.0 / pp->dwell_ema : 20.0;
+  if (now - pp->last_scroll_time < 2.0 && pp->scroll_rate_ema > pages_per_sec)
+    pages_per_sec = pp->scroll_rate_ema;
+
+  // Time to bring in one more page (guess until something has arrived)
+  double fetch_time = 0.5;
+  if (pp->throughput_ema > 0 && pp->page_size_ema > 0)
+    fetch_time = pp->page_size_ema / pp->throughput_ema;
+
+  int ahead = (int)ceil(pages_per_sec * (PREFETCH_HORIZON + fetch_time)) + 1;
+  if (ahead < PREFETCH_MIN_AHEAD)
+    ahead = PREFETCH_MIN_AHEAD;
+  if (ahead > PREFETCH_MAX_AHEAD)
+    ahead = PREFETCH_MAX_AHEAD;
+
+  // Readers who page back get a real window behind them too
+  int behind = 1;
+  if (pp->backward_ema > 0.15)
+    behind = ahead / 2 > 2 ? ahead / 2 : 2;
+  if (behind > PREFETCH_MAX_BEHIND)
+    behind = PREFETCH_MAX_BEHIND;
+
+  // Leave a quarter of the cache for pages the reader is looking at
+  if (pp->page_size_ema > 0) {
+    int fit = (int)(cache_budget * 0.75 / pp->page_size_ema);
+    if (ahead + behind > fit) {
+      behind = behind * fit / (ahead + behind);
+      ahead = fit - behind;
+      if (ahead < 1)
+        ahead = 1;
+    }
+  }
+
+  pp->ahead = ahead;
+  pp->behind = behind;
+}
@@ -1,6 +1,31 @@
 #include "render_engine.h"
+#include "jpeg_decode.h"
+#include "resample.h"
 #include <SDL2/SDL_image.h>
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Format pages are decoded to and uploaded in: the renderer's own, picked
+// in init_sdl() before any decoding starts
+static Uint32 page_format = SDL_PIXELFORMAT_ARGB8888;
+
+// 32-bit formats decode_page() can produce, as renderers list them
+static const Uint32 page_formats[] = {
+    SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ABGR8888,
+    SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_BGR888};
+
+// First format in the renderer's preference order that pages can use
+static Uint32 native_page_format(const SDL_RendererInfo *info) {
+  for (Uint32 i = 0; i < info->num_texture_formats; i++) {
+    for (int j = 0; j < (int)(sizeof(page_formats) / sizeof(Uint32)); j++) {
+      if (info->texture_formats[i] == page_formats[j])
+        return page_formats[j];
+    }
+  }
+  return SDL_PIXELFORMAT_ARGB8888;
+}
 
 // --- 1. INITIALIZATION & CLEANUP ---
 
@@ -35,23 +60,65 @@ int init_sdl(AppContext *ctx, int width, int height) {
 
   ctx->renderer = SDL_CreateRenderer(
       ctx->window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+  if (!ctx->renderer) // no GPU
+    ctx->renderer =
+        SDL_CreateRenderer(ctx->window, -1, SDL_RENDERER_SOFTWARE);
+  if (!ctx->renderer)
+    return -1;
 
-  // Initialize Texture Slots
-  ctx->tex_prev = NULL;
-  ctx->tex_curr = NULL;
-  ctx->tex_next = NULL;
+  // Tiles must fit the renderer's texture limit
+  ctx->tile_height = PAGE_TILE_HEIGHT;
+  ctx->software = 0;
+  SDL_RendererInfo info;
+  memset(&info, 0, sizeof(info));
+  if (SDL_GetRendererInfo(ctx->renderer, &info) == 0) {
+    if (info.max_texture_height > 0 &&
+        info.max_texture_height < PAGE_TILE_HEIGHT)
+      ctx->tile_height = info.max_texture_height;
+    page_format = native_page_format(&info);
+    ctx->software = (info.flags & SDL_RENDERER_SOFTWARE) != 0;
+  }
+  if (ctx->software)
+    printf("Software renderer: drawing pages unscaled\n");
+  ctx->frame_tex[0] = ctx->frame_tex[1] = NULL;
+  ctx->frame_cur = 0;
+  ctx->frame_reusable = 0;
+  texture_pool_init(&ctx->textures, ctx->renderer, page_format,
+                    info.max_texture_width, info.max_texture_height);
+
+  // Initialize Texture Ring
+  memset(ctx->ring, 0, sizeof(ctx->ring));
+  for (int i = 0; i < TEXTURE_RING_SIZE; i++)
+    ctx->ring[i].page = -1;
+  set_slot_window(ctx, 0, 0, 0);
+  ctx->strip_margin = 100;
+  ctx->decode_w = 0; // full size until the first update_decode_size()
+  ctx->decode_h = 0;
+  ctx->resize_pending = 0;
+  ctx->upload_budget = (size_t)16 * 1024 * 1024;
+  ctx->upload_left = ctx->upload_budget;
+  ctx->dirty = 1;
+  text_cache_init(&ctx->text, ctx->renderer, ctx->font);
+  scrubber_init(&ctx->scrubber);
+  strip_layout_init(&ctx->strip);
+  ctx->strip_stale = 1;
+
+  decode_pool_init(&ctx->decode_pool, ctx->renderer, 0);
   return 0;
 }
 
 void cleanup_sdl(AppContext *ctx) {
+  clear_slots(ctx);
+  decode_pool_shutdown(&ctx->decode_pool);
+  text_cache_clear(&ctx->text);
+  scrubber_free(&ctx->scrubber);
+  strip_layout_free(&ctx->strip);
   if (ctx->font)
     TTF_CloseFont(ctx->font);
-  if (ctx->tex_prev)
-    SDL_DestroyTexture(ctx->tex_prev);
-  if (ctx->tex_curr)
-    SDL_DestroyTexture(ctx->tex_curr);
-  if (ctx->tex_next)
-    SDL_DestroyTexture(ctx->tex_next);
+  texture_pool_clear(&ctx->textures);
+  for (int i = 0; i < 2; i++)
+    if (ctx->frame_tex[i])
+      SDL_DestroyTexture(ctx->frame_tex[i]);
   if (ctx->renderer)
     SDL_DestroyRenderer(ctx->renderer);
   if (ctx->window)
@@ -61,89 +128,498 @@ void cleanup_sdl(AppContext *ctx) {
   SDL_Quit();
 }
 
+// --- Page textures ---
+
+// Size of page as stored, when the provider measured it already (the
+// decoded texture's, scaled, has the same shape). Returns 0 if unknown.
+static int known_size(const AppContext *ctx, int page, int *w, int *h) {
+  if (!ctx->page_sizes || page < 0 || page >= ctx->page_count ||
+      ctx->page_sizes[page].w <= 0 || ctx->page_sizes[page].h <= 0)
+    return 0;
+  *w = ctx->page_sizes[page].w;
+  *h = ctx->page_sizes[page].h;
+  return 1;
+}
+
+// The strip layout takes a page's height from its texture until the page
+// is measured, so it is built again when such a page comes or goes
+static void strip_page_changed(AppContext *ctx, int page) {
+  int w, h;
+  if (page >= 0 && !known_size(ctx, page, &w, &h))
+    ctx->strip_stale = 1;
+}
+
+// Drop an entry's image (textures and kept pixels). Its textures go back
+// to the pool for the next page.
+static void release_image(AppContext *ctx, PageTexture *e) {
+  for (int i = 0; i < e->tile_count; i++) {
+    texture_pool_release(&ctx->textures, e->tiles[i]);
+    e->tiles[i] = NULL;
+  }
+  if (e->pixels) {
+    SDL_FreeSurface(e->pixels);
+    e->pixels = NULL;
+  }
+  if (e->tile_count > 0)
+    strip_page_changed(ctx, e->page);
+  e->tile_count = 0;
+  e->w = 0;
+  e->h = 0;
+  ctx->frame_reusable = 0;
+}
+
+// Forget the page an entry holds (image, pending decode)
+static void reset_entry(AppContext *ctx, PageTexture *e) {
+  release_image(ctx, e);
+  if (e->page >= 0) // nobody wants it decoded any more
+    decode_pool_cancel_job(&ctx->decode_pool, ctx, e->page, e->gen);
+  e->page = -1;
+  e->preview = 0;
+  e->gen++; // drops decodes still in flight
+}
+
+void set_page_sizes(AppContext *ctx, const PageSize *sizes, int count) {
+  ctx->page_sizes = sizes;
+  ctx->page_count = count;
+  ctx->strip_stale = 1;
+  ctx->dirty = 1;
+}
+
 void clear_slots(AppContext *ctx) {
-  if (ctx->tex_prev) {
-    SDL_DestroyTexture(ctx->tex_prev);
-    ctx->tex_prev = NULL;
+  for (int i = 0; i < TEXTURE_RING_SIZE; i++)
+    reset_entry(ctx, &ctx->ring[i]);
+  set_page_sizes(ctx, NULL, 0); // until the reader hands them over again
+  ctx->dirty = 1;
+}
+
+SDL_Surface *decode_page(const char *buffer, size_t size, int max_w,
+                         int max_h) {
+  if (!buffer)
+    return NULL;
+  // Most scans are JPEGs: let libjpeg skip most of the work when the page
+  // is shown at a fraction of its size
+  SDL_Surface *surface = jpeg_decode(buffer, size, max_w, max_h, page_format);
+  int opaque = 1;
+  if (!surface) {
+    SDL_RWops *rw = SDL_RWFromConstMem(buffer, size);
+    surface = IMG_Load_RW(rw, 1);
+    if (surface)
+      opaque = !SDL_ISPIXELFORMAT_ALPHA(surface->format->format) &&
+               !SDL_HasColorKey(surface);
   }
-  if (ctx->tex_curr) {
-    SDL_DestroyTexture(ctx->tex_curr);
-    ctx->tex_curr = NULL;
+  if (!surface)
+    return NULL;
+
+  // Convert here rather than on the render thread; uploads are then plain
+  // row copies into the renderer's textures
+  if (surface->format->format != page_format) {
+    SDL_Surface *converted = SDL_ConvertSurfaceFormat(surface, page_format, 0);
+    SDL_FreeSurface(surface);
+    surface = converted;
+    if (!surface)
+      return NULL;
   }
-  if (ctx->tex_next) {
-    SDL_DestroyTexture(ctx->tex_next);
-    ctx->tex_next = NULL;
+
+  // Shrink to the size it is shown at, so the GPU neither stores nor
+  // minifies pixels that never reach the screen. Keep the full image if
+  // resampling fails.
+  int w, h;
+  if (resample_fit(surface->w, surface->h, max_w, max_h, &w, &h)) {
+    SDL_Surface *scaled = resample_area(surface, w, h);
+    if (scaled) {
+      SDL_FreeSurface(surface);
+      surface = scaled;
+    }
   }
+  // page_format has an alpha channel either way; the blend mode records
+  // whether the page actually uses it, and the texture inherits it
+  SDL_SetSurfaceBlendMode(surface,
+                          opaque ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
+  return surface;
 }
 
-void load_texture_to_slot(AppContext *ctx, char *buffer, size_t size,
-                          int slot) {
-  // Determine which pointer to use: -1=Prev, 0=Curr, 1=Next
-  SDL_Texture **target = (slot == -1)  ? &ctx->tex_prev
-                         : (slot == 1) ? &ctx->tex_next
-                                       : &ctx->tex_curr;
+int update_decode_size(AppContext *ctx, ViewMode mode,
+                       ManhwaScale scale_mode) {
+  int win_w, win_h;
+  if (SDL_GetRendererOutputSize(ctx->renderer, &win_w, &win_h) != 0 ||
+      win_w <= 0 || win_h <= 0)
+    return 0;
 
-  // Clear existing texture in this slot
-  if (*target) {
-    SDL_DestroyTexture(*target);
-    *target = NULL;
+  // Every view fits pages inside the output, except the fit-width strip
+  // whose pages may run past its bottom
+  int max_w = win_w;
+  int max_h = (mode == VIEW_MANHWA && scale_mode == SCALE_FIT_WIDTH) ? 0
+                                                                      : win_h;
+  // Without a GPU, facing pages are decoded to share the width so they
+  // are drawn 1:1 as well
+  if (ctx->software && (mode == VIEW_DOUBLE || mode == VIEW_DOUBLE_COVER))
+    max_w = win_w / 2;
+  if (max_w == ctx->decode_w && max_h == ctx->decode_h) {
+    ctx->resize_pending = 0;
+    return 0;
   }
 
-  if (!buffer)
+  // Let a resize settle before decoding everything again
+  Uint32 now = SDL_GetTicks();
+  if (!ctx->resize_pending || max_w != ctx->pending_w ||
+      max_h != ctx->pending_h) {
+    ctx->resize_pending = 1;
+    ctx->pending_w = max_w;
+    ctx->pending_h = max_h;
+    ctx->pending_since = now;
+  }
+  if (ctx->decode_w > 0 && now - ctx->pending_since < DECODE_RESIZE_DELAY_MS)
+    return 0;
+
+  ctx->resize_pending = 0;
+  ctx->decode_w = max_w;
+  ctx->decode_h = max_h;
+  clear_slots(ctx);
+  return 1;
+}
+
+static PageTexture *ring_entry(AppContext *ctx, int page) {
+  return &ctx->ring[page % TEXTURE_RING_SIZE];
+}
+
+// Page shown in a slot (-1=Prev, 0=Curr, 1=Next), NULL if the slot is
+// hidden or its page is not decoded yet
+static PageTexture *slot_entry(AppContext *ctx, int slot) {
+  if (slot < ctx->slot_first || slot > ctx->slot_last)
+    return NULL;
+  int page = ctx->slot_page + slot;
+  if (page < 0)
+    return NULL;
+  PageTexture *e = ring_entry(ctx, page);
+  return (e->page == page && e->tile_count > 0) ? e : NULL;
+}
+
+// Hand the ring entry for page over to it, dropping whatever page it held
+static PageTexture *claim_entry(AppContext *ctx, int page) {
+  PageTexture *e = ring_entry(ctx, page);
+  reset_entry(ctx, e);
+  e->page = page;
+  return e;
+}
+
+void upload_budget_reset(AppContext *ctx) {
+  ctx->upload_left = ctx->upload_budget;
+}
+
+int upload_budget_take(AppContext *ctx, size_t bytes) {
+  if (ctx->upload_budget == 0)
+    return 1;
+  if (bytes > ctx->upload_left && ctx->upload_left < ctx->upload_budget) {
+    ctx->dirty = 1; // there is more to upload next frame
+    return 0;
+  }
+  ctx->upload_left = bytes < ctx->upload_left ? ctx->upload_left - bytes : 0;
+  return 1;
+}
+
+// Upload tile i of a page from its kept pixels, if the frame's budget
+// allows. A single-tile page lets go of its pixels once uploaded.
+static void upload_tile(AppContext *ctx, PageTexture *e, int i) {
+  if (e->tiles[i] || !e->pixels)
+    return;
+  int y0 = i * e->tile_h;
+  int rows = (e->h - y0 < e->tile_h) ? e->h - y0 : e->tile_h;
+  if (!upload_budget_take(ctx, (size_t)e->pixels->pitch * rows))
     return;
 
-  SDL_RWops *rw = SDL_RWFromMem(buffer, size);
-  SDL_Surface *surface = IMG_Load_RW(rw, 1);
+  SDL_Texture *tex = texture_pool_acquire(&ctx->textures, e->w, rows);
+  if (texture_pool_upload(&ctx->textures, tex, e->pixels, y0, rows) != 0) {
+    texture_pool_release(&ctx->textures, tex);
+    return;
+  }
+  e->tiles[i] = tex;
 
-  if (surface) {
-    *target = SDL_CreateTextureFromSurface(ctx->renderer, surface);
-    SDL_FreeSurface(surface);
+  if (e->tile_count == 1) {
+    SDL_FreeSurface(e->pixels);
+    e->pixels = NULL;
   }
 }
 
-SDL_Texture *render_text_texture(SDL_Renderer *renderer, TTF_Font *font,
-                                 const char *text, SDL_Color color, int *out_w,
-                                 int *out_h) {
-  SDL_Surface *surf = TTF_RenderText_Blended(font, text, color);
-  if (!surf)
-    return NULL;
-  SDL_Texture *tex = SDL_CreateTextureFromSurface(renderer, surf);
-  if (out_w)
-    *out_w = surf->w;
-  if (out_h)
-    *out_h = surf->h;
-  SDL_FreeSurface(surf);
-  return tex;
+// Give a claimed entry its decoded page, replacing a stand-in it may show.
+// Nothing is uploaded yet: the entry keeps the pixels and render_frame()
+// uploads them within its budget, visible pages first. Returns 1 if the
+// entry kept surface (only when owned, i.e. the caller would free it
+// otherwise).
+static int set_page_surface(AppContext *ctx, PageTexture *e,
+                            SDL_Surface *surface, int owned) {
+  release_image(ctx, e);
+  e->preview = 0;
+  ctx->dirty = 1;
+  if (!surface)
+    return 0; // stays blank rather than decoding it again every frame
+
+  e->w = surface->w;
+  e->h = surface->h;
+  strip_page_changed(ctx, e->page);
+  e->tile_h = ctx->tile_height;
+  if (e->h > e->tile_h * PAGE_MAX_TILES)
+    e->tile_h = (e->h + PAGE_MAX_TILES - 1) / PAGE_MAX_TILES;
+  e->tile_count = (e->h + e->tile_h - 1) / e->tile_h;
+
+  // Pages arrive in page_format; anything else is converted once here
+  SDL_Surface *converted = NULL;
+  if (surface->format->format != page_format) {
+    converted = SDL_ConvertSurfaceFormat(surface, page_format, 0);
+    if (!converted) {
+      reset_entry(ctx, e);
+      return 0;
+    }
+  }
+
+  if (converted) {
+    e->pixels = converted;
+    return 0;
+  }
+  if (owned) {
+    e->pixels = surface;
+    return 1;
+  }
+  e->pixels = SDL_ConvertSurfaceFormat(surface, page_format, 0); // a copy
+  if (!e->pixels) {
+    reset_entry(ctx, e);
+    return 0;
+  }
+  // Converting turns blending on for any alpha format; keep the page's
+  SDL_BlendMode mode;
+  if (SDL_GetSurfaceBlendMode(surface, &mode) == 0)
+    SDL_SetSurfaceBlendMode(e->pixels, mode);
+  return 0;
+}
+
+void set_slot_window(AppContext *ctx, int page, int first, int last) {
+  if (page != ctx->slot_page || first != ctx->slot_first ||
+      last != ctx->slot_last)
+    ctx->dirty = 1;
+  ctx->slot_page = page;
+  ctx->slot_first = first;
+  ctx->slot_last = last;
+
+  // Evict pages that scrolled well out of the window; keep a couple on
+  // each side so stepping back and forth reuses them
+  for (int i = 0; i < TEXTURE_RING_SIZE; i++) {
+    PageTexture *e = &ctx->ring[i];
+    if (e->page < 0 || (e->page >= page + first - TEXTURE_RING_KEEP &&
+                        e->page <= page + last + TEXTURE_RING_KEEP))
+      continue;
+    reset_entry(ctx, e);
+  }
+}
+
+int page_texture_loaded(AppContext *ctx, int page) {
+  if (page < 0)
+    return 0;
+  PageTexture *e = ring_entry(ctx, page);
+  return e->page == page && e->preview != 1;
+}
+
+void load_surface_to_page(AppContext *ctx, SDL_Surface *surface, int page) {
+  if (page < 0)
+    return;
+  set_page_surface(ctx, claim_entry(ctx, page), surface, 0);
+}
+
+// Decode pool callback: keep the page unless the entry was reassigned
+static int page_decoded(SDL_Renderer *renderer, void *user, int page,
+                        unsigned gen, SDL_Surface *surface) {
+  AppContext *ctx = (AppContext *)user;
+  PageTexture *e = ring_entry(ctx, page);
+  if (e->page != page || e->gen != gen)
+    return 0;
+  return set_page_surface(ctx, e, surface, 1);
+}
+
+void queue_page_decode(AppContext *ctx, PageBuffer *buf, int page) {
+  if (page < 0 || !buf) {
+    page_buffer_release(buf);
+    return;
+  }
+  // A stand-in stays up until the page replaces it
+  PageTexture *e = ring_entry(ctx, page);
+  if (e->page == page && e->preview)
+    e->preview = 2;
+  else
+    e = claim_entry(ctx, page);
+  decode_pool_submit(&ctx->decode_pool, buf, ctx->decode_w, ctx->decode_h,
+                     page_decoded, ctx, page, e->gen);
+}
+
+// Decode pool callback for stand-ins: shown only while the entry has
+// nothing better
+static int preview_decoded(SDL_Renderer *renderer, void *user, int page,
+                           unsigned gen, SDL_Surface *surface) {
+  AppContext *ctx = (AppContext *)user;
+  PageTexture *e = ring_entry(ctx, page);
+  if (!surface || e->page != page || e->gen != gen || !e->preview ||
+      e->tile_count > 0)
+    return 0;
+  int preview = e->preview;
+  int kept = set_page_surface(ctx, e, surface, 1);
+  e->preview = preview;
+  return kept;
+}
+
+void queue_preview_decode(AppContext *ctx, PageBuffer *buf, int page,
+                          int reduce) {
+  int max_w = ctx->decode_w, max_h = ctx->decode_h;
+  if (reduce) {
+    max_w /= PAGE_PREVIEW_SCALE;
+    max_h /= PAGE_PREVIEW_SCALE;
+  }
+  // Only JPEGs decode at a fraction of the cost; anything else would take
+  // as long as the page itself
+  int jpeg = buf && buf->size > 2 && (unsigned char)buf->data[0] == 0xFF &&
+             (unsigned char)buf->data[1] == 0xD8;
+  if (page < 0 || !buf || (reduce && (max_w <= 0 || !jpeg))) {
+    page_buffer_release(buf);
+    return;
+  }
+  if (ring_entry(ctx, page)->page == page) {
+    page_buffer_release(buf); // the page, or a stand-in, is on its way
+    return;
+  }
+  PageTexture *e = claim_entry(ctx, page);
+  e->preview = 1;
+  decode_pool_submit(&ctx->decode_pool, buf, max_w, max_h, preview_decoded,
+                     ctx, page, e->gen);
 }
 
 // --- 2. HELPER FUNCTIONS ---
 
-// Calculates the on-screen height of a texture based on the current scaling
-// mode
-int get_scaled_height(AppContext *ctx, int slot, ManhwaScale scale_mode) {
-  SDL_Texture *tex = (slot == -1)  ? ctx->tex_prev
-                     : (slot == 1) ? ctx->tex_next
-                                   : ctx->tex_curr;
-  if (!tex)
+// Scale factor of a webtoon page of w x h pixels in the current mode
+static float strip_scale(int w, int h, int win_w, int win_h,
+                         ManhwaScale scale_mode) {
+  if (scale_mode == SCALE_FIT_WIDTH) {
+    // Mode 'd': Scale to fit width, height grows proportionally
+    return (float)win_w / w;
+  }
+  // Mode 's': Scale to fit height (standard view)
+  float scale = (float)win_h / h;
+  // Don't let it be wider than the screen
+  if (w * scale > win_w)
+    scale = (float)win_w / w;
+  return scale;
+}
+
+// Dimensions a strip page is laid out with: its measured size if known, so
+// the layout doesn't shift when the decode lands, else the decoded entry's
+static int page_dims(const AppContext *ctx, int page, const PageTexture *e,
+                     int *w, int *h) {
+  if (known_size(ctx, page, w, h))
+    return 1;
+  if (!e || e->page != page || e->w <= 0 || e->h <= 0)
     return 0;
+  *w = e->w;
+  *h = e->h;
+  return 1;
+}
 
+// On-screen height of page in the strip, 0 while neither measured nor
+// decoded
+static int strip_height(AppContext *ctx, int page, const PageTexture *e,
+                        ManhwaScale scale_mode) {
   int w, h;
-  SDL_QueryTexture(tex, NULL, NULL, &w, &h);
+  if (!page_dims(ctx, page, e, &w, &h))
+    return 0;
 
   int win_w, win_h;
   SDL_GetRendererOutputSize(ctx->renderer, &win_w, &win_h);
+  return (int)(h * strip_scale(w, h, win_w, win_h, scale_mode));
+}
 
-  if (scale_mode == SCALE_FIT_WIDTH) {
-    // Mode 'd': Scale to fit width, height grows proportionally
-    float scale = (float)win_w / w;
-    return (int)(h * scale);
-  } else {
-    // Mode 's': Scale to fit height (standard view)
-    float scale = (float)win_h / h;
-    // Don't let it be wider than the screen
-    if (w * scale > win_w)
-      scale = (float)win_w / w;
-    return (int)(h * scale);
+// Calculates the on-screen height of a page based on the current scaling
+// mode
+int get_scaled_height(AppContext *ctx, int slot, ManhwaScale scale_mode) {
+  return strip_height(ctx, ctx->slot_page + slot, slot_entry(ctx, slot),
+                      scale_mode);
+}
+
+// Bring the strip layout up to date: measured pages at their size,
+// decoded ones at their texture's, and the rest at the average of those
+// (one screen while there are none yet)
+static const StripLayout *strip_layout(AppContext *ctx,
+                                       ManhwaScale scale_mode) {
+  int win_w, win_h;
+  SDL_GetRendererOutputSize(ctx->renderer, &win_w, &win_h);
+  if (!ctx->strip_stale && win_w == ctx->strip_w && win_h == ctx->strip_h &&
+      scale_mode == ctx->strip_scale)
+    return &ctx->strip;
+
+  StripLayout *l = &ctx->strip;
+  if (strip_layout_reserve(l, ctx->page_count) != 0) {
+    strip_layout_reserve(l, 0);
+    return l;
+  }
+  long long known = 0;
+  int known_count = 0;
+  for (int i = 0; i < l->count; i++) {
+    PageTexture *e = ring_entry(ctx, i);
+    int h = strip_height(ctx, i, e->tile_count > 0 ? e : NULL, scale_mode);
+    l->top[i + 1] = h; // heights for now, 0 = unknown
+    if (h > 0) {
+      known += h;
+      known_count++;
+    }
+  }
+  int guess = known_count > 0 ? (int)(known / known_count) : win_h;
+  for (int i = 0; i < l->count; i++)
+    l->top[i + 1] = l->top[i] + (l->top[i + 1] > 0 ? l->top[i + 1] : guess);
+
+  ctx->strip_stale = 0;
+  ctx->strip_w = win_w;
+  ctx->strip_h = win_h;
+  ctx->strip_scale = scale_mode;
+  return l;
+}
+
+long long strip_position(AppContext *ctx, ManhwaScale scale_mode, int page,
+                         int offset) {
+  return strip_layout_offset(strip_layout(ctx, scale_mode), page, offset);
+}
+
+int strip_locate(AppContext *ctx, ManhwaScale scale_mode, long long pos,
+                 int *offset) {
+  return strip_layout_locate(strip_layout(ctx, scale_mode), pos, offset);
+}
+
+int strip_page_height(AppContext *ctx, ManhwaScale scale_mode, int page) {
+  return strip_layout_height(strip_layout(ctx, scale_mode), page);
+}
+
+long long strip_length(AppContext *ctx, ManhwaScale scale_mode) {
+  const StripLayout *l = strip_layout(ctx, scale_mode);
+  return l->count > 0 ? l->top[l->count] : 0;
+}
+
+void strip_span(AppContext *ctx, ManhwaScale scale_mode, int scroll_y,
+                int page, int count, int *first, int *last) {
+  int win_w, win_h;
+  SDL_GetRendererOutputSize(ctx->renderer, &win_w, &win_h);
+  int margin = win_h * ctx->strip_margin / 100;
+  const StripLayout *l = strip_layout(ctx, scale_mode);
+  if (l->count < count)
+    count = l->count;
+
+  // Downwards from the top of the current page...
+  *last = 0;
+  int bottom = -scroll_y + strip_layout_height(l, page);
+  while (bottom < win_h + margin && page + *last + 1 < count &&
+         *last + 1 < STRIP_MAX_PAGES - 1) {
+    (*last)++;
+    bottom += strip_layout_height(l, page + *last);
+  }
+
+  // ...then upwards, with whatever room the ring has left
+  *first = 0;
+  int top = -scroll_y;
+  while (top > -margin && page + *first > 0 &&
+         *last - *first + 1 < STRIP_MAX_PAGES) {
+    (*first)--;
+    top -= strip_layout_height(l, page + *first);
   }
 }
 
@@ -158,11 +634,12 @@ void render_help_menu(AppContext *ctx, ReadMode mode) {
                              "D : Double Page View",
                              "Shift+D : Double (Skip Cover)",
                              "G : Go to Page",
+                             "T : Page Scrubber",
                              "B / E : Start / End",
                              "F : Fullscreen",
                              "H : Close Help",
                              "ESC : Quit"};
-  int count_std = 11;
+  int count_std = 12;
 
   const char *lines_manhwa[] = {"--- HELP MENU (Manhwa) ---",
                                 "Scroll / Arrows : Continuous Read",
@@ -170,11 +647,12 @@ void render_help_menu(AppContext *ctx, ReadMode mode) {
                                 "S : Fit Height (Default)",
                                 "d : Fit Width (Zoomed)",
                                 "G : Go to Page",
+                                "T : Page Scrubber",
                                 "B / E : Start / End",
                                 "F : Fullscreen",
                                 "H : Close Help",
                                 "ESC : Quit"};
-  int count_manhwa = 10;
+  int count_manhwa = 11;
 
   const char **lines = (mode == MODE_MANHWA) ? lines_manhwa : lines_std;
   int count = (mode == MODE_MANHWA) ? count_manhwa : count_std;
@@ -190,18 +668,33 @@ void render_help_menu(AppContext *ctx, ReadMode mode) {
   SDL_GetRendererOutputSize(ctx->renderer, &win_w, &win_h);
 
   for (int i = 0; i < count; i++) {
-    SDL_Surface *surf = TTF_RenderText_Blended(ctx->font, lines[i], white);
-    if (surf) {
-      SDL_Texture *tex = SDL_CreateTextureFromSurface(ctx->renderer, surf);
-      SDL_Rect dest = {(win_w - surf->w) / 2, y, surf->w, surf->h};
+    int w, h;
+    SDL_Texture *tex = text_cache_get(&ctx->text, lines[i], white, 0, &w, &h);
+    if (tex) {
+      SDL_Rect dest = {(win_w - w) / 2, y, w, h};
       SDL_RenderCopy(ctx->renderer, tex, NULL, &dest);
-      y += surf->h + 10;
-      SDL_FreeSurface(surf);
-      SDL_DestroyTexture(tex);
+      y += h + 10;
     }
   }
 }
 
+// Page counter texture with where it goes (dest) and its background box
+// (bg); NULL if there is nothing to draw
+static SDL_Texture *overlay_box(AppContext *ctx, const char *overlay_text,
+                                int win_w, int win_h, SDL_Rect *dest,
+                                SDL_Rect *bg) {
+  SDL_Color white = {255, 255, 255, 255};
+  int w, h;
+  SDL_Texture *t = overlay_text ? text_cache_get(&ctx->text, overlay_text,
+                                                 white, 0, &w, &h)
+                                : NULL;
+  if (!t)
+    return NULL;
+  *dest = (SDL_Rect){win_w - w - 20, win_h - h - 10, w, h};
+  *bg = (SDL_Rect){dest->x - 5, dest->y - 5, dest->w + 10, dest->h + 10};
+  return t;
+}
+
 void draw_ui(AppContext *ctx, const char *overlay_text,
              const char *input_text) {
   if (!ctx->font)
@@ -212,20 +705,15 @@ void draw_ui(AppContext *ctx, const char *overlay_text,
 
   // 1. Page Counter Overlay
   if (overlay_text) {
-    SDL_Surface *s = TTF_RenderText_Blended(ctx->font, overlay_text, white);
-    if (s) {
-      SDL_Texture *t = SDL_CreateTextureFromSurface(ctx->renderer, s);
-      SDL_Rect dest = {win_w - s->w - 20, win_h - s->h - 10, s->w, s->h};
-
+    SDL_Rect dest, bg;
+    SDL_Texture *t = overlay_box(ctx, overlay_text, win_w, win_h, &dest, &bg);
+    if (t) {
       // Background Box
-      SDL_Rect bg = {dest.x - 5, dest.y - 5, dest.w + 10, dest.h + 10};
       SDL_SetRenderDrawBlendMode(ctx->renderer, SDL_BLENDMODE_BLEND);
       SDL_SetRenderDrawColor(ctx->renderer, 0, 0, 0, 150);
       SDL_RenderFillRect(ctx->renderer, &bg);
 
       SDL_RenderCopy(ctx->renderer, t, NULL, &dest);
-      SDL_FreeSurface(s);
-      SDL_DestroyTexture(t);
     }
   }
 
@@ -233,10 +721,10 @@ void draw_ui(AppContext *ctx, const char *overlay_text,
   if (input_text) {
     char buf[64];
     snprintf(buf, 64, "Go to: %s_", input_text);
-    SDL_Surface *s = TTF_RenderText_Blended(ctx->font, buf, white);
-    if (s) {
-      SDL_Texture *t = SDL_CreateTextureFromSurface(ctx->renderer, s);
-      SDL_Rect dest = {(win_w - s->w) / 2, (win_h - s->h) / 2, s->w, s->h};
+    int w, h;
+    SDL_Texture *t = text_cache_get(&ctx->text, buf, white, 0, &w, &h);
+    if (t) {
+      SDL_Rect dest = {(win_w - w) / 2, (win_h - h) / 2, w, h};
 
       SDL_Rect bg = {dest.x - 20, dest.y - 20, dest.w + 40, dest.h + 40};
       SDL_SetRenderDrawColor(ctx->renderer, 0, 0, 0, 220);
@@ -246,120 +734,313 @@ void draw_ui(AppContext *ctx, const char *overlay_text,
       SDL_RenderDrawRect(ctx->renderer, &bg);
 
       SDL_RenderCopy(ctx->renderer, t, NULL, &dest);
-      SDL_FreeSurface(s);
-      SDL_DestroyTexture(t);
     }
   }
 }
 
 // --- 3. MAIN RENDER FUNCTION ---
 
+#define UPLOAD_QUEUE_SIZE 64
+
+// Uploads a frame makes ahead of need: tiles just outside the window and
+// neighbouring pages. They run after everything visible is drawn, lowest
+// priority first, with whatever is left of the frame's budget.
+typedef struct {
+  PageTexture *e;
+  int tile;
+  int priority;
+} UploadItem;
+
+typedef struct {
+  UploadItem items[UPLOAD_QUEUE_SIZE];
+  int count;
+} UploadQueue;
+
+// Priority of a slot: the current page, then the next, the previous, the
+// one after next...
+static int slot_priority(int slot) {
+  return slot > 0 ? 2 * slot - 1 : -2 * slot;
+}
+
+static void queue_upload(UploadQueue *q, PageTexture *e, int tile,
+                         int priority) {
+  if (e->tiles[tile] || !e->pixels || q->count == UPLOAD_QUEUE_SIZE)
+    return;
+  // Insertion keeps the queue sorted, and in arrival order within a
+  // priority
+  int i = q->count++;
+  while (i > 0 && q->items[i - 1].priority > priority) {
+    q->items[i] = q->items[i - 1];
+    i--;
+  }
+  q->items[i] = (UploadItem){e, tile, priority};
+}
+
+// Queue the neighbours' pages that still wait for their texture. Tall
+// pages are left to draw_page(), which knows which of their tiles are near.
+static void queue_neighbours(AppContext *ctx, UploadQueue *q) {
+  for (int slot = ctx->slot_first - TEXTURE_RING_KEEP;
+       slot <= ctx->slot_last + TEXTURE_RING_KEEP; slot++) {
+    int page = ctx->slot_page + slot;
+    if (page < 0)
+      continue;
+    PageTexture *e = ring_entry(ctx, page);
+    if (e->page == page && e->tile_count == 1)
+      queue_upload(q, e, 0, slot_priority(slot));
+  }
+}
+
+static void run_uploads(AppContext *ctx, UploadQueue *q) {
+  for (int i = 0; i < q->count; i++)
+    upload_tile(ctx, q->items[i].e, q->items[i].tile);
+}
+
+// Draw a page scaled into dest, tile by tile. Visible tiles are uploaded
+// on the spot (within the frame's budget); tiles near the window are
+// queued at priority, and tiles of tall pages are released once well past
+// the window.
+static void draw_page(AppContext *ctx, PageTexture *e, SDL_FRect dest,
+                      int win_h, UploadQueue *q, int priority) {
+  // Pages are decoded at the size they are shown, give or take rounding.
+  // Snapped to exactly that, the software renderer blits them instead of
+  // stretching every pixel.
+  if (ctx->software && fabsf(dest.w - e->w) < 2 && fabsf(dest.h - e->h) < 2)
+    dest = (SDL_FRect){floorf(dest.x + 0.5f), floorf(dest.y + 0.5f),
+                       (float)e->w, (float)e->h};
+  float scale = dest.h / e->h;
+  for (int i = 0; i < e->tile_count; i++) {
+    int y0 = i * e->tile_h;
+    int rows = (e->h - y0 < e->tile_h) ? e->h - y0 : e->tile_h;
+    SDL_FRect tile = {dest.x, dest.y + y0 * scale, dest.w, rows * scale};
+
+    if (tile.y + tile.h < -win_h || tile.y > 2 * win_h) {
+      if (e->pixels && e->tiles[i]) {
+        texture_pool_release(&ctx->textures, e->tiles[i]);
+        e->tiles[i] = NULL;
+      }
+      continue;
+    }
+    if (tile.y + tile.h < -win_h / 2 || tile.y > win_h + win_h / 2)
+      continue;
+    if (tile.y + tile.h < 0 || tile.y > win_h) {
+      queue_upload(q, e, i, priority);
+      continue;
+    }
+
+    upload_tile(ctx, e, i);
+    // Pooled textures may be larger than the tile
+    SDL_Rect src = {0, 0, e->w, rows};
+    if (e->tiles[i])
+      SDL_RenderCopyF(ctx->renderer, e->tiles[i], &src, &tile);
+    else
+      ctx->frame_reusable = 0; // a hole to fill in a later frame
+  }
+}
+
+// Draw one webtoon page with its top edge at y; returns its drawn height
+static int draw_strip_page(AppContext *ctx, PageTexture *e,
+                           ManhwaScale scale_mode, int y, int win_w,
+                           int win_h, UploadQueue *q, int slot) {
+  int w = e->w, h = e->h;
+  page_dims(ctx, ctx->slot_page + slot, e, &w, &h);
+  float scale = strip_scale(w, h, win_w, win_h, scale_mode);
+  int center_x =
+      (scale_mode == SCALE_FIT_WIDTH) ? 0 : (win_w - w * scale) / 2;
+
+  SDL_FRect dest = {(float)center_x, (float)y, w * scale, h * scale};
+  draw_page(ctx, e, dest, win_h, q, slot_priority(slot));
+  return (int)(h * scale);
+}
+
+// Current page at -scroll_y, the rest of the strip stacked below and above
+// it. A page that isn't decoded yet leaves a gap of its height when it has
+// been measured, and ends the strip on that side when not.
+static void draw_strip(AppContext *ctx, ManhwaScale scale_mode, int scroll_y,
+                       int win_w, int win_h, UploadQueue *q) {
+  int y = -scroll_y;
+  for (int slot = 0; slot <= ctx->slot_last && y < win_h; slot++) {
+    PageTexture *e = slot_entry(ctx, slot);
+    if (e) {
+      y += draw_strip_page(ctx, e, scale_mode, y, win_w, win_h, q, slot);
+      continue;
+    }
+    int h = strip_height(ctx, ctx->slot_page + slot, NULL, scale_mode);
+    if (h <= 0)
+      break;
+    y += h;
+    ctx->frame_reusable = 0; // the gap fills in a later frame
+  }
+  if (y < win_h)
+    ctx->frame_reusable = 0; // the strip ends on screen, pages may follow
+
+  y = -scroll_y;
+  for (int slot = -1; slot >= ctx->slot_first && y > 0; slot--) {
+    PageTexture *e = slot_entry(ctx, slot);
+    int h = strip_height(ctx, ctx->slot_page + slot, e, scale_mode);
+    if (h <= 0)
+      break;
+    y -= h;
+    if (e)
+      draw_strip_page(ctx, e, scale_mode, y, win_w, win_h, q, slot);
+    else
+      ctx->frame_reusable = 0;
+  }
+  if (y > 0)
+    ctx->frame_reusable = 0;
+}
+
+// Frame texture i at w x h, made again when the window changed size.
+// NULL when the renderer can't draw into textures.
+static SDL_Texture *frame_texture(AppContext *ctx, int i, int w, int h) {
+  SDL_Texture *t = ctx->frame_tex[i];
+  int tex_w, tex_h;
+  if (t && SDL_QueryTexture(t, NULL, NULL, &tex_w, &tex_h) == 0 &&
+      tex_w == w && tex_h == h)
+    return t;
+  if (t)
+    SDL_DestroyTexture(t);
+  t = SDL_CreateTexture(ctx->renderer, page_format, SDL_TEXTUREACCESS_TARGET,
+                        w, h);
+  if (t)
+    SDL_SetTextureBlendMode(t, SDL_BLENDMODE_NONE);
+  ctx->frame_tex[i] = t;
+  return t;
+}
+
+// Software renderer, webtoon strip: draw the frame into the current frame
+// texture. Returns 0 (and leaves the window as the target) if there is
+// none.
+static int begin_frame(AppContext *ctx, int win_w, int win_h) {
+  SDL_Texture *t = frame_texture(ctx, ctx->frame_cur, win_w, win_h);
+  return t && SDL_SetRenderTarget(ctx->renderer, t) == 0;
+}
+
+// Software renderer, webtoon strip: when only the scroll position changed
+// since the last frame, start this one in the other frame texture with the
+// last frame's rows, moved by the difference, instead of drawing
+// everything again. The rows that scrolled in are left for the caller to
+// draw, in exposed. Returns 0 if the frame has to be drawn in full.
+static int scroll_frame(AppContext *ctx, ManhwaScale scale_mode, int scroll_y,
+                        int win_w, int win_h, SDL_Rect *exposed) {
+  int dy = scroll_y - ctx->frame_scroll;
+  if (!ctx->software || !ctx->frame_reusable ||
+      ctx->slot_page != ctx->frame_page || scale_mode != ctx->frame_scale ||
+      win_w != ctx->frame_w || win_h != ctx->frame_h || abs(dy) >= win_h)
+    return 0;
+
+  // A texture can't be copied onto itself, hence two
+  SDL_Texture *last = ctx->frame_tex[ctx->frame_cur];
+  SDL_Texture *next = frame_texture(ctx, !ctx->frame_cur, win_w, win_h);
+  if (!last || !next || SDL_SetRenderTarget(ctx->renderer, next) != 0)
+    return 0;
+  int kept = win_h - abs(dy);
+  SDL_Rect src = {0, dy > 0 ? dy : 0, win_w, kept};
+  SDL_Rect dst = {0, dy > 0 ? 0 : -dy, win_w, kept};
+  if (SDL_RenderCopy(ctx->renderer, last, &src, &dst) != 0) {
+    SDL_SetRenderTarget(ctx->renderer, NULL);
+    return 0;
+  }
+  ctx->frame_cur = !ctx->frame_cur;
+  *exposed = dy > 0 ? (SDL_Rect){0, kept, win_w, dy}
+                    : (SDL_Rect){0, 0, win_w, -dy};
+  return 1;
+}
+
+// Draw the strip again inside r only, over whatever the frame holds there
+static void repaint_strip(AppContext *ctx, SDL_Rect r, ManhwaScale scale_mode,
+                          int scroll_y, int win_w, int win_h, UploadQueue *q) {
+  if (r.w <= 0 || r.h <= 0)
+    return;
+  SDL_RenderSetClipRect(ctx->renderer, &r);
+  SDL_SetRenderDrawBlendMode(ctx->renderer, SDL_BLENDMODE_NONE);
+  SDL_SetRenderDrawColor(ctx->renderer, 30, 30, 30, 255);
+  SDL_RenderFillRect(ctx->renderer, &r);
+  draw_strip(ctx, scale_mode, scroll_y, win_w, win_h, q);
+  SDL_RenderSetClipRect(ctx->renderer, NULL);
+}
+
 void render_frame(AppContext *ctx, const char *overlay_text,
                   const char *input_text, ViewMode mode, ManhwaScale scale_mode,
                   PageDir dir, int show_help, int scroll_y, ReadMode book_mode,
                   const char *popup_message) {
+  ctx->dirty = 0;
+  upload_budget_reset(ctx);
+  UploadQueue uploads;
+  uploads.count = 0;
 
-  SDL_SetRenderDrawColor(ctx->renderer, 30, 30, 30, 255);
-  SDL_RenderClear(ctx->renderer);
+  int win_w, win_h;
+  SDL_GetRendererOutputSize(ctx->renderer, &win_w, &win_h);
+
+  // Scrolling the strip without a GPU: keep what is still on screen
+  int strip_frame = mode == VIEW_MANHWA && !show_help && !input_text &&
+                    !popup_message && !ctx->scrubber.open;
+  SDL_Rect exposed;
+  int scrolled =
+      strip_frame &&
+      scroll_frame(ctx, scale_mode, scroll_y, win_w, win_h, &exposed);
+  int framed = scrolled;
+  if (!scrolled) {
+    framed = strip_frame && ctx->software && begin_frame(ctx, win_w, win_h);
+    SDL_SetRenderDrawColor(ctx->renderer, 30, 30, 30, 255);
+    SDL_RenderClear(ctx->renderer);
+  }
 
   // 1. HELP MENU (Exclusive View)
   if (show_help) {
+    ctx->frame_reusable = 0;
     render_help_menu(ctx, book_mode);
     SDL_RenderPresent(ctx->renderer);
     return;
   }
 
-  int win_w, win_h;
-  SDL_GetRendererOutputSize(ctx->renderer, &win_w, &win_h);
+  PageTexture *page_curr = slot_entry(ctx, 0);
+  PageTexture *page_next = slot_entry(ctx, 1);
 
   // ==========================================
   // LOGIC 1: MANHWA CONTINUOUS SCROLL
   // ==========================================
   if (mode == VIEW_MANHWA) {
-    int center_x = 0;
-
-    // --- A. Draw Current Page (Middle) ---
-    if (ctx->tex_curr) {
-      int w, h;
-      SDL_QueryTexture(ctx->tex_curr, NULL, NULL, &w, &h);
-      float scale;
-      if (scale_mode == SCALE_FIT_WIDTH)
-        scale = (float)win_w / w;
-      else { // Fit Height
-        scale = (float)win_h / h;
-        if (w * scale > win_w)
-          scale = (float)win_w / w;
-        center_x = (win_w - (w * scale)) / 2;
-      }
-      SDL_FRect dest = {(float)center_x, (float)-scroll_y, w * scale,
-                        h * scale};
-      SDL_RenderCopyF(ctx->renderer, ctx->tex_curr, NULL, &dest);
+    if (scrolled) {
+      repaint_strip(ctx, exposed, scale_mode, scroll_y, win_w, win_h,
+                    &uploads);
+    } else {
+      ctx->frame_reusable = framed;
+      draw_strip(ctx, scale_mode, scroll_y, win_w, win_h, &uploads);
     }
-
-    // --- B. Draw Next Page (Below) ---
-    if (ctx->tex_next) {
-      int curr_h = get_scaled_height(ctx, 0, scale_mode);
-      int w, h;
-      SDL_QueryTexture(ctx->tex_next, NULL, NULL, &w, &h);
-      float scale;
-      if (scale_mode == SCALE_FIT_WIDTH)
-        scale = (float)win_w / w;
-      else {
-        scale = (float)win_h / h;
-        if (w * scale > win_w)
-          scale = (float)win_w / w;
-        center_x = (win_w - (w * scale)) / 2;
-      }
-      // Position: Starts exactly where Current ends
-      SDL_FRect dest = {(float)center_x, (float)(-scroll_y + curr_h), w * scale,
-                        h * scale};
-      SDL_RenderCopyF(ctx->renderer, ctx->tex_next, NULL, &dest);
-    }
-
-    // --- C. Draw Prev Page (Above) ---
-    if (ctx->tex_prev) {
-      int prev_h = get_scaled_height(ctx, -1, scale_mode);
-      int w, h;
-      SDL_QueryTexture(ctx->tex_prev, NULL, NULL, &w, &h);
-      float scale;
-      if (scale_mode == SCALE_FIT_WIDTH)
-        scale = (float)win_w / w;
-      else {
-        scale = (float)win_h / h;
-        if (w * scale > win_w)
-          scale = (float)win_w / w;
-        center_x = (win_w - (w * scale)) / 2;
-      }
-      // Position: Ends exactly where Current starts
-      SDL_FRect dest = {(float)center_x, (float)(-scroll_y - prev_h), w * scale,
-                        h * scale};
-      SDL_RenderCopyF(ctx->renderer, ctx->tex_prev, NULL, &dest);
+    // The page counter goes over the copy, never into the frame
+    if (framed) {
+      SDL_SetRenderTarget(ctx->renderer, NULL);
+      SDL_RenderCopy(ctx->renderer, ctx->frame_tex[ctx->frame_cur], NULL,
+                     NULL);
     }
+    ctx->frame_page = ctx->slot_page;
+    ctx->frame_scroll = scroll_y;
+    ctx->frame_scale = scale_mode;
+    ctx->frame_w = win_w;
+    ctx->frame_h = win_h;
   }
   // ==========================================
   // LOGIC 2: STANDARD (Manga/Comic)
   // ==========================================
   else {
+    ctx->frame_reusable = 0;
     // --- SINGLE VIEW ---
-    if (mode == VIEW_SINGLE || !ctx->tex_next) {
-      if (ctx->tex_curr) {
-        int w, h;
-        SDL_QueryTexture(ctx->tex_curr, NULL, NULL, &w, &h);
+    if (mode == VIEW_SINGLE || !page_next) {
+      if (page_curr) {
+        int w = page_curr->w, h = page_curr->h;
         float scale = (float)win_h / h;
         if (w * scale > win_w)
           scale = (float)win_w / w;
 
         SDL_FRect dest = {(win_w - w * scale) / 2, (win_h - h * scale) / 2,
                           w * scale, h * scale};
-        SDL_RenderCopyF(ctx->renderer, ctx->tex_curr, NULL, &dest);
+        draw_page(ctx, page_curr, dest, win_h, &uploads, 0);
       }
     }
     // --- DOUBLE VIEW ---
-    else {
-      int w1, h1, w2, h2;
-      SDL_QueryTexture(ctx->tex_curr, NULL, NULL, &w1, &h1);
-      SDL_QueryTexture(ctx->tex_next, NULL, NULL, &w2,
-                       &h2); // tex_next is secondary page
+    else if (page_curr) {
+      int w1 = page_curr->w, h1 = page_curr->h;
+      int w2 = page_next->w, h2 = page_next->h; // page_next is secondary page
 
       // Scale both to fit height
       float scale = (float)win_h / (h1 > h2 ? h1 : h2);
@@ -387,13 +1068,18 @@ void render_frame(AppContext *ctx, const char *overlay_text,
         dest2 = (SDL_FRect){start_x + dw1, y2, dw2, h2 * scale}; // Right
       }
 
-      SDL_RenderCopyF(ctx->renderer, ctx->tex_next, NULL, &dest2);
-      SDL_RenderCopyF(ctx->renderer, ctx->tex_curr, NULL, &dest1);
+      draw_page(ctx, page_curr, dest1, win_h, &uploads, 0);
+      draw_page(ctx, page_next, dest2, win_h, &uploads, 1);
     }
   }
 
+  // Spend what is left of the budget on what comes next
+  queue_neighbours(ctx, &uploads);
+  run_uploads(ctx, &uploads);
+
   // 3. UI OVERLAYS (Page Count, Input Box)
   draw_ui(ctx, overlay_text, input_text);
+  scrubber_draw(&ctx->scrubber, ctx->renderer, &ctx->text);
 
   // 4. POPUP MESSAGE (New!)
   if (popup_message) {
@@ -413,12 +1099,11 @@ void render_popup(AppContext *ctx, const char *message) {
   SDL_Color white = {255, 255, 255, 255};
   SDL_Color accent = {100, 149, 237, 255}; // Cornflower Blue
 
-  SDL_Surface *s = TTF_RenderText_Blended(ctx->font, message, white);
-  if (s) {
-    SDL_Texture *t = SDL_CreateTextureFromSurface(ctx->renderer, s);
-
-    int box_w = s->w + 40;
-    int box_h = s->h + 40;
+  int w, h;
+  SDL_Texture *t = text_cache_get(&ctx->text, message, white, 0, &w, &h);
+  if (t) {
+    int box_w = w + 40;
+    int box_h = h + 40;
     SDL_Rect box = {(win_w - box_w) / 2, (win_h - box_h) / 2, box_w, box_h};
 
     // Draw Shadow
@@ -437,10 +1122,7 @@ void render_popup(AppContext *ctx, const char *message) {
     SDL_RenderDrawRect(ctx->renderer, &box);
 
     // Draw Text
-    SDL_Rect text_dest = {box.x + 20, box.y + 20, s->w, s->h};
+    SDL_Rect text_dest = {box.x + 20, box.y + 20, w, h};
     SDL_RenderCopy(ctx->renderer, t, NULL, &text_dest);
-
-    SDL_FreeSurface(s);
-    SDL_DestroyTexture(t);
   }
 }
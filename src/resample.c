@@ -0,0 +1,220 @@
+#include "resample.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Weights are 2.14 fixed point and sum to 1 << WEIGHT_BITS per output
+// pixel. The horizontal pass keeps 7 fractional bits per channel so the
+// intermediate fits a signed 16-bit lane (255 << 7 = 32640).
+#define WEIGHT_BITS 14
+#define MID_BITS 7
+
+// For each destination pixel along one axis: the first source pixel it
+// covers, how many, and their weights (taps per pixel, zero padded)
+typedef struct {
+  int *start;
+  int *count;
+  int16_t *weights;
+  int taps;
+} AreaKernel;
+
+static int kernel_init(AreaKernel *k, int src_len, int dst_len) {
+  double scale = (double)src_len / dst_len;
+  k->taps = (int)scale + 2;
+  k->start = malloc(dst_len * sizeof(int));
+  k->count = malloc(dst_len * sizeof(int));
+  k->weights = calloc((size_t)dst_len * k->taps, sizeof(int16_t));
+  if (!k->start || !k->count || !k->weights)
+    return -1;
+
+  for (int i = 0; i < dst_len; i++) {
+    double lo = i * scale;
+    double hi = (i + 1) * scale;
+    int first = (int)lo;
+    int last = (int)hi;
+    if (last >= src_len || (double)last == hi)
+      last--;
+    if (last >= src_len)
+      last = src_len - 1;
+
+    int16_t *w = k->weights + (size_t)i * k->taps;
+    int n = last - first + 1;
+    if (n > k->taps)
+      n = k->taps;
+    int sum = 0, heaviest = 0;
+    for (int t = 0; t < n; t++) {
+      double a = first + t > lo ? first + t : lo;
+      double b = first + t + 1 < hi ? first + t + 1 : hi;
+      w[t] = (int16_t)((b - a) / scale * (1 << WEIGHT_BITS) + 0.5);
+      sum += w[t];
+      if (w[t] > w[heaviest])
+        heaviest = t;
+    }
+    // Rounding leftovers go to the heaviest tap so flat areas stay exact
+    w[heaviest] += (1 << WEIGHT_BITS) - sum;
+    k->start[i] = first;
+    k->count[i] = n;
+  }
+  return 0;
+}
+
+static void kernel_free(AreaKernel *k) {
+  free(k->start);
+  free(k->count);
+  free(k->weights);
+}
+
+// One source row -> dst_w pixels of 4 x int16 (MID_BITS fraction)
+static void resample_row(const uint32_t *src, int16_t *dst, int dst_w,
+                         const AreaKernel *k) {
+  for (int x = 0; x < dst_w; x++) {
+    const uint32_t *p = src + k->start[x];
+    const int16_t *w = k->weights + (size_t)x * k->taps;
+    int n = k->count[x];
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    for (int t = 0; t < n; t++) {
+      __m128i px = _mm_cvtsi32_si128((int)p[t]);
+      px = _mm_unpacklo_epi16(_mm_unpacklo_epi8(px, zero), zero);
+      acc = _mm_add_epi32(acc, _mm_madd_epi16(px, _mm_set1_epi32(w[t])));
+    }
+    acc = _mm_srai_epi32(
+        _mm_add_epi32(acc, _mm_set1_epi32(1 << (WEIGHT_BITS - MID_BITS - 1))),
+        WEIGHT_BITS - MID_BITS);
+    _mm_storel_epi64((__m128i *)(dst + x * 4), _mm_packs_epi32(acc, zero));
+#else
+    int32_t acc[4] = {0, 0, 0, 0};
+    for (int t = 0; t < n; t++) {
+      for (int c = 0; c < 4; c++)
+        acc[c] += (int32_t)((p[t] >> (c * 8)) & 0xff) * w[t];
+    }
+    for (int c = 0; c < 4; c++)
+      dst[x * 4 + c] = (int16_t)((acc[c] + (1 << (WEIGHT_BITS - MID_BITS - 1)))
+                                 >> (WEIGHT_BITS - MID_BITS));
+#endif
+  }
+}
+
+// Weighted sum of n intermediate rows -> one destination row
+static void resample_column(int16_t *const *rows, const int16_t *w, int n,
+                            uint32_t *dst, int dst_w) {
+  const int shift = WEIGHT_BITS + MID_BITS;
+  const int32_t round = 1 << (shift - 1);
+  int x = 0;
+#ifdef __SSE2__
+  const __m128i zero = _mm_setzero_si128();
+  for (; x + 2 <= dst_w; x += 2) {
+    __m128i lo = _mm_set1_epi32(round), hi = lo;
+    for (int t = 0; t < n; t++) {
+      __m128i v = _mm_loadu_si128((const __m128i *)(rows[t] + x * 4));
+      __m128i wt = _mm_set1_epi32(w[t]);
+      lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(v, zero), wt));
+      hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(v, zero), wt));
+    }
+    lo = _mm_srai_epi32(lo, shift);
+    hi = _mm_srai_epi32(hi, shift);
+    __m128i px = _mm_packus_epi16(_mm_packs_epi32(lo, hi), zero);
+    _mm_storel_epi64((__m128i *)(dst + x), px);
+  }
+#endif
+  for (; x < dst_w; x++) {
+    uint32_t out = 0;
+    for (int c = 0; c < 4; c++) {
+      int32_t acc = round;
+      for (int t = 0; t < n; t++)
+        acc += rows[t][x * 4 + c] * w[t];
+      acc >>= shift;
+      if (acc > 255)
+        acc = 255;
+      if (acc < 0)
+        acc = 0;
+      out |= (uint32_t)acc << (c * 8);
+    }
+    dst[x] = out;
+  }
+}
+
+int resample_fit(int w, int h, int max_w, int max_h, int *out_w, int *out_h) {
+  if (w <= 0 || h <= 0)
+    return 0;
+  double scale = 1.0;
+  if (max_w > 0 && (double)max_w / w < scale)
+    scale = (double)max_w / w;
+  if (max_h > 0 && (double)max_h / h < scale)
+    scale = (double)max_h / h;
+  if (scale >= 1.0)
+    return 0;
+
+  *out_w = (int)(w * scale + 0.5);
+  *out_h = (int)(h * scale + 0.5);
+  if (*out_w < 1)
+    *out_w = 1;
+  if (*out_h < 1)
+    *out_h = 1;
+  return 1;
+}
+
+SDL_Surface *resample_area(SDL_Surface *src, int dst_w, int dst_h) {
+  if (!src || src->format->BytesPerPixel != 4 || dst_w <= 0 || dst_h <= 0 ||
+      dst_w > src->w || dst_h > src->h)
+    return NULL;
+
+  SDL_Surface *dst = SDL_CreateRGBSurfaceWithFormat(
+      0, dst_w, dst_h, 32, src->format->format);
+  if (!dst)
+    return NULL;
+
+  AreaKernel kx, ky;
+  memset(&kx, 0, sizeof(kx));
+  memset(&ky, 0, sizeof(ky));
+  // Horizontally resampled source rows, kept in a ring: consecutive output
+  // rows share at most one source row, so ky.taps + 1 rows are plenty.
+  int ring = 0;
+  int16_t *mid = NULL;
+  int16_t **rows = NULL;
+  if (kernel_init(&kx, src->w, dst_w) != 0 ||
+      kernel_init(&ky, src->h, dst_h) != 0)
+    goto fail;
+  ring = ky.taps + 1;
+  mid = malloc((size_t)ring * dst_w * 4 * sizeof(int16_t));
+  rows = malloc(ky.taps * sizeof(int16_t *));
+  if (!mid || !rows)
+    goto fail;
+
+  int next_row = 0; // next source row to run through the horizontal pass
+  for (int y = 0; y < dst_h; y++) {
+    int first = ky.start[y];
+    int n = ky.count[y];
+    for (; next_row < first + n; next_row++) {
+      const uint32_t *in =
+          (const uint32_t *)((const Uint8 *)src->pixels +
+                             (size_t)next_row * src->pitch);
+      resample_row(in, mid + (size_t)(next_row % ring) * dst_w * 4, dst_w,
+                   &kx);
+    }
+    for (int t = 0; t < n; t++)
+      rows[t] = mid + (size_t)((first + t) % ring) * dst_w * 4;
+
+    uint32_t *out = (uint32_t *)((Uint8 *)dst->pixels + (size_t)y * dst->pitch);
+    resample_column(rows, ky.weights + (size_t)y * ky.taps, n, out, dst_w);
+  }
+
+  free(rows);
+  free(mid);
+  kernel_free(&kx);
+  kernel_free(&ky);
+  return dst;
+
+fail:
+  free(rows);
+  free(mid);
+  kernel_free(&kx);
+  kernel_free(&ky);
+  SDL_FreeSurface(dst);
+  return NULL;
+}
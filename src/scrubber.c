@@ -0,0 +1,265 @@
+#include "scrubber.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SCRUB_PAD 10  // space around the bar's contents
+#define SCRUB_GAP 6   // space between thumbnails
+#define SCRUB_TRACK_H 12
+
+// --- Internal helpers ---
+
+static int clamp_page(const Scrubber *s, int page) {
+  if (page >= s->count)
+    page = s->count - 1;
+  return page < 0 ? 0 : page;
+}
+
+static SDL_Rect cell_rect(const Scrubber *s, int cell) {
+  return (SDL_Rect){(cell % s->cols) * SCRUB_THUMB_W,
+                    (cell / s->cols) * SCRUB_THUMB_H, SCRUB_THUMB_W,
+                    SCRUB_THUMB_H};
+}
+
+// Atlas as large as the renderer allows, up to SCRUB_ATLAS_SIZE square
+static int create_atlas(Scrubber *s, SDL_Renderer *renderer, Uint32 format) {
+  int edge_w = SCRUB_ATLAS_SIZE, edge_h = SCRUB_ATLAS_SIZE;
+  SDL_RendererInfo info;
+  if (SDL_GetRendererInfo(renderer, &info) == 0) {
+    if (info.max_texture_width > 0 && info.max_texture_width < edge_w)
+      edge_w = info.max_texture_width;
+    if (info.max_texture_height > 0 && info.max_texture_height < edge_h)
+      edge_h = info.max_texture_height;
+  }
+  int cols = edge_w / SCRUB_THUMB_W, rows = edge_h / SCRUB_THUMB_H;
+  if (cols <= 0 || rows <= 0)
+    return -1;
+
+  s->atlas = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STATIC,
+                               cols * SCRUB_THUMB_W, rows * SCRUB_THUMB_H);
+  if (!s->atlas) {
+    fprintf(stderr, "Warning: scrubber atlas: %s\n", SDL_GetError());
+    return -1;
+  }
+  s->cols = cols;
+  s->cells = cols * rows;
+  return 0;
+}
+
+// Where the bar's parts go on an output of win_w x win_h with a label of
+// label_h rows, and which thumbnails the row has room for
+static void layout(Scrubber *s, int win_w, int win_h, int label_h) {
+  int bar_h = SCRUB_PAD + label_h + SCRUB_PAD / 2 + SCRUB_THUMB_H +
+              SCRUB_PAD + SCRUB_TRACK_H + SCRUB_PAD;
+  s->bar = (SDL_Rect){0, win_h - bar_h, win_w, bar_h};
+
+  // An odd number of thumbnails, so the current one sits in the middle
+  int shown = (win_w - 2 * SCRUB_PAD + SCRUB_GAP) / (SCRUB_THUMB_W + SCRUB_GAP);
+  if (shown % 2 == 0)
+    shown--;
+  if (shown > s->count)
+    shown = s->count;
+  if (shown < 1)
+    shown = 1;
+  s->shown = shown;
+  s->first = s->index - shown / 2;
+  if (s->first > s->count - shown)
+    s->first = s->count - shown;
+  if (s->first < 0)
+    s->first = 0;
+
+  int row_w = shown * (SCRUB_THUMB_W + SCRUB_GAP) - SCRUB_GAP;
+  int row_y = s->bar.y + SCRUB_PAD + label_h + SCRUB_PAD / 2;
+  s->row = (SDL_Rect){(win_w - row_w) / 2, row_y, row_w, SCRUB_THUMB_H};
+  s->track = (SDL_Rect){SCRUB_PAD, row_y + SCRUB_THUMB_H + SCRUB_PAD,
+                        win_w - 2 * SCRUB_PAD, SCRUB_TRACK_H};
+}
+
+static int in_rect(const SDL_Rect *r, int x, int y) {
+  return x >= r->x && x < r->x + r->w && y >= r->y && y < r->y + r->h;
+}
+
+// Page at x on the track
+static int track_page(const Scrubber *s, int x) {
+  if (s->track.w <= 1 || s->count <= 1)
+    return 0;
+  double t = (double)(x - s->track.x) / (s->track.w - 1);
+  return clamp_page(s, (int)(t * (s->count - 1) + 0.5));
+}
+
+// --- Public API ---
+
+void scrubber_init(Scrubber *s) {
+  memset(s, 0, sizeof(Scrubber));
+  scrubber_reset(s);
+}
+
+void scrubber_free(Scrubber *s) {
+  if (s->atlas)
+    SDL_DestroyTexture(s->atlas);
+  s->atlas = NULL;
+  scrubber_reset(s);
+}
+
+void scrubber_reset(Scrubber *s) {
+  scrubber_close(s);
+  s->count = 0;
+  for (int i = 0; i < SCRUB_MAX_CELLS; i++)
+    s->cell_page[i] = -1;
+}
+
+void scrubber_open(Scrubber *s, int index, int count) {
+  s->open = 1;
+  s->count = count;
+  s->dragging = 0;
+  s->index = clamp_page(s, index);
+}
+
+void scrubber_close(Scrubber *s) {
+  s->open = 0;
+  s->dragging = 0;
+  s->bar = (SDL_Rect){0, 0, 0, 0};
+}
+
+int scrubber_set(Scrubber *s, int index) {
+  index = clamp_page(s, index);
+  if (index == s->index)
+    return 0;
+  s->index = index;
+  return 1;
+}
+
+void scrubber_range(const Scrubber *s, int *first, int *last) {
+  if (!s->open || s->count <= 0) {
+    *first = 0;
+    *last = -1;
+    return;
+  }
+  // The whole book when the atlas has room for it (nearest pages still come
+  // first), otherwise a row's worth either side of the thumbnails on screen
+  int cells = s->cells > 0 ? s->cells : SCRUB_MAX_CELLS;
+  if (s->count <= cells) {
+    *first = 0;
+    *last = s->count - 1;
+    return;
+  }
+  int shown = s->shown > 0 ? s->shown : 15;
+  *first = clamp_page(s, s->index - shown);
+  *last = clamp_page(s, s->index + shown);
+}
+
+int scrubber_has(const Scrubber *s, int page) {
+  return s->cells > 0 && page >= 0 && s->cell_page[page % s->cells] == page;
+}
+
+int scrubber_store(Scrubber *s, SDL_Renderer *renderer, int page,
+                   const SDL_Surface *thumb) {
+  if (page < 0 || !thumb)
+    return -1;
+  if (!s->atlas && create_atlas(s, renderer, thumb->format->format) != 0)
+    return -1;
+
+  Uint32 format;
+  int cell = page % s->cells;
+  SDL_Rect dest = cell_rect(s, cell);
+  dest.w = thumb->w < SCRUB_THUMB_W ? thumb->w : SCRUB_THUMB_W;
+  dest.h = thumb->h < SCRUB_THUMB_H ? thumb->h : SCRUB_THUMB_H;
+  // A thumbnail that can't go in still takes its cell, so it is not asked
+  // for again every frame; it draws as a blank
+  s->cell_page[cell] = page;
+  s->cell_size[cell] = (SDL_Point){0, 0};
+  if (SDL_QueryTexture(s->atlas, &format, NULL, NULL, NULL) != 0 ||
+      format != thumb->format->format ||
+      SDL_UpdateTexture(s->atlas, &dest, thumb->pixels, thumb->pitch) != 0)
+    return -1;
+  s->cell_size[cell] = (SDL_Point){dest.w, dest.h};
+  return 0;
+}
+
+void scrubber_draw(Scrubber *s, SDL_Renderer *renderer, TextCache *text) {
+  if (!s->open || s->count <= 0)
+    return;
+  int win_w, win_h;
+  SDL_GetRendererOutputSize(renderer, &win_w, &win_h);
+  SDL_Color white = {255, 255, 255, 255};
+  SDL_Color accent = {100, 149, 237, 255}; // Cornflower Blue
+
+  char label[48];
+  snprintf(label, sizeof(label), "Page %d / %d", s->index + 1, s->count);
+  int label_w = 0, label_h = 0;
+  SDL_Texture *label_tex =
+      text_cache_get(text, label, white, 0, &label_w, &label_h);
+  layout(s, win_w, win_h, label_h);
+
+  SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 200);
+  SDL_RenderFillRect(renderer, &s->bar);
+
+  if (label_tex) {
+    SDL_Rect dest = {(win_w - label_w) / 2, s->bar.y + SCRUB_PAD, label_w,
+                     label_h};
+    SDL_RenderCopy(renderer, label_tex, NULL, &dest);
+  }
+
+  // Thumbnails, centred in their cells; grey boxes until they arrive
+  for (int i = 0; i < s->shown; i++) {
+    int page = s->first + i;
+    SDL_Rect cell = {s->row.x + i * (SCRUB_THUMB_W + SCRUB_GAP), s->row.y,
+                     SCRUB_THUMB_W, SCRUB_THUMB_H};
+    SDL_Point size = {0, 0};
+    if (scrubber_has(s, page))
+      size = s->cell_size[page % s->cells];
+    if (size.x > 0 && size.y > 0) {
+      SDL_Rect src = cell_rect(s, page % s->cells);
+      src.w = size.x;
+      src.h = size.y;
+      SDL_Rect dest = {cell.x + (SCRUB_THUMB_W - size.x) / 2,
+                       cell.y + (SCRUB_THUMB_H - size.y) / 2, size.x, size.y};
+      SDL_RenderCopy(renderer, s->atlas, &src, &dest);
+    } else {
+      SDL_SetRenderDrawColor(renderer, 60, 60, 60, 255);
+      SDL_RenderFillRect(renderer, &cell);
+    }
+    if (page == s->index) {
+      SDL_Rect border = {cell.x - 2, cell.y - 2, cell.w + 4, cell.h + 4};
+      SDL_SetRenderDrawColor(renderer, accent.r, accent.g, accent.b, 255);
+      SDL_RenderDrawRect(renderer, &border);
+      border = (SDL_Rect){cell.x - 1, cell.y - 1, cell.w + 2, cell.h + 2};
+      SDL_RenderDrawRect(renderer, &border);
+    }
+  }
+
+  // Track with a marker at the current position
+  SDL_Rect line = {s->track.x, s->track.y + SCRUB_TRACK_H / 2 - 2, s->track.w,
+                   4};
+  SDL_SetRenderDrawColor(renderer, 90, 90, 90, 255);
+  SDL_RenderFillRect(renderer, &line);
+  int mx = s->track.x;
+  if (s->count > 1)
+    mx += (int)((long)s->index * (s->track.w - 1) / (s->count - 1));
+  SDL_Rect marker = {mx - 3, s->track.y, 6, SCRUB_TRACK_H};
+  SDL_SetRenderDrawColor(renderer, accent.r, accent.g, accent.b, 255);
+  SDL_RenderFillRect(renderer, &marker);
+}
+
+int scrubber_press(Scrubber *s, int x, int y) {
+  if (!s->open || !in_rect(&s->bar, x, y))
+    return 0;
+  if (in_rect(&s->row, x, y)) {
+    int i = (x - s->row.x) / (SCRUB_THUMB_W + SCRUB_GAP);
+    s->dragging = 1;
+    return scrubber_set(s, s->first + (i < s->shown ? i : s->shown - 1));
+  }
+  s->dragging = 2;
+  return scrubber_set(s, track_page(s, x));
+}
+
+int scrubber_motion(Scrubber *s, int x) {
+  // The row recentres on every move, so only the track follows the pointer
+  return s->dragging == 2 && scrubber_set(s, track_page(s, x));
+}
+
+int scrubber_release(Scrubber *s) {
+  int pressed = s->dragging != 0;
+  s->dragging = 0;
+  return pressed;
+}
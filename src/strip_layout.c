@@ -0,0 +1,59 @@
+#include "strip_layout.h"
+#include <stdlib.h>
+#include <string.h>
+
+void strip_layout_init(StripLayout *l) { memset(l, 0, sizeof(StripLayout)); }
+
+void strip_layout_free(StripLayout *l) {
+  free(l->top);
+  strip_layout_init(l);
+}
+
+int strip_layout_reserve(StripLayout *l, int count) {
+  if (count < 0)
+    count = 0;
+  if (!l->top || count > l->capacity) {
+    long long *top = realloc(l->top, (count + 1) * sizeof(long long));
+    if (!top)
+      return -1;
+    l->top = top;
+    l->capacity = count;
+  }
+  l->count = count;
+  l->top[0] = 0;
+  return 0;
+}
+
+long long strip_layout_offset(const StripLayout *l, int page, int offset) {
+  if (l->count <= 0)
+    return offset;
+  if (page < 0)
+    page = 0;
+  if (page >= l->count)
+    page = l->count - 1;
+  return l->top[page] + offset;
+}
+
+int strip_layout_locate(const StripLayout *l, long long pos, int *offset) {
+  if (l->count <= 0) {
+    *offset = (int)pos;
+    return 0;
+  }
+  // Last page whose top is at or above pos
+  int lo = 0, hi = l->count - 1;
+  while (lo < hi) {
+    int mid = lo + (hi - lo + 1) / 2;
+    if (l->top[mid] <= pos)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  *offset = (int)(pos - l->top[lo]);
+  return lo;
+}
+
+int strip_layout_height(const StripLayout *l, int page) {
+  if (page < 0 || page >= l->count)
+    return 0;
+  return (int)(l->top[page + 1] - l->top[page]);
+}
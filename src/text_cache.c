@@ -0,0 +1,135 @@
+#include "text_cache.h"
+#include <stdlib.h>
+#include <string.h>
+
+// --- Internal helpers ---
+
+static Uint32 text_hash(const char *text, SDL_Color color, int max_w) {
+  Uint32 h = 2166136261u; // FNV-1a
+  for (const unsigned char *p = (const unsigned char *)text; *p; p++)
+    h = (h ^ *p) * 16777619u;
+  h = (h ^ ((Uint32)color.r << 24 | (Uint32)color.g << 16 |
+            (Uint32)color.b << 8 | color.a)) *
+      16777619u;
+  return (h ^ (Uint32)max_w) * 16777619u;
+}
+
+static void free_entry(TextEntry *e) {
+  if (e->texture)
+    SDL_DestroyTexture(e->texture);
+  free(e->text);
+  memset(e, 0, sizeof(TextEntry));
+}
+
+// Longest prefix of text that fits max_w once "..." is appended, written to
+// buf. Binary search, so a long title costs a handful of TTF_SizeText calls.
+static void fit_text(TTF_Font *font, const char *text, int max_w, char *buf,
+                     size_t buf_size) {
+  int w, h;
+  strncpy(buf, text, buf_size - 1);
+  buf[buf_size - 1] = '\0';
+  if (TTF_SizeText(font, buf, &w, &h) != 0 || w <= max_w)
+    return;
+
+  size_t len = strlen(buf);
+  if (len > buf_size - 4)
+    len = buf_size - 4; // room for "..." and the terminator
+  size_t lo = 0, hi = len; // lo always fits (an empty prefix is assumed to)
+  while (lo < hi) {
+    size_t mid = (lo + hi + 1) / 2;
+    memcpy(buf, text, mid);
+    strcpy(buf + mid, "...");
+    if (TTF_SizeText(font, buf, &w, &h) == 0 && w <= max_w)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  memcpy(buf, text, lo);
+  strcpy(buf + lo, "...");
+}
+
+// --- Public API ---
+
+void text_cache_init(TextCache *tc, SDL_Renderer *renderer, TTF_Font *font) {
+  memset(tc, 0, sizeof(TextCache));
+  tc->renderer = renderer;
+  tc->font = font;
+}
+
+void text_cache_clear(TextCache *tc) {
+  for (int i = 0; i < TEXT_CACHE_SIZE; i++)
+    free_entry(&tc->entries[i]);
+}
+
+SDL_Texture *text_cache_get(TextCache *tc, const char *text, SDL_Color color,
+                            int max_w, int *out_w, int *out_h) {
+  if (!tc->font || !text || !text[0])
+    return NULL;
+
+  Uint32 hash = text_hash(text, color, max_w);
+  TextEntry *victim = &tc->entries[0];
+  for (int i = 0; i < TEXT_CACHE_SIZE; i++) {
+    TextEntry *e = &tc->entries[i];
+    if (e->texture && e->hash == hash && e->max_w == max_w &&
+        e->color.r == color.r && e->color.g == color.g &&
+        e->color.b == color.b && e->color.a == color.a &&
+        strcmp(e->text, text) == 0) {
+      e->last_used = ++tc->clock;
+      if (out_w)
+        *out_w = e->w;
+      if (out_h)
+        *out_h = e->h;
+      return e->texture;
+    }
+    // Free entries first, then the least recently used one
+    if (victim->texture && (!e->texture || e->last_used < victim->last_used))
+      victim = e;
+  }
+
+  // Miss: rasterise into the victim's place
+  char buf[256];
+  if (max_w > 0)
+    fit_text(tc->font, text, max_w, buf, sizeof(buf));
+  else {
+    strncpy(buf, text, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+  }
+  SDL_Surface *surf = TTF_RenderText_Blended(tc->font, buf, color);
+  if (!surf)
+    return NULL;
+  SDL_Texture *tex = SDL_CreateTextureFromSurface(tc->renderer, surf);
+  int w = surf->w, h = surf->h;
+  SDL_FreeSurface(surf);
+  char *key = strdup(text);
+  if (!tex || !key) {
+    if (tex)
+      SDL_DestroyTexture(tex);
+    free(key);
+    return NULL;
+  }
+
+  free_entry(victim);
+  victim->texture = tex;
+  victim->text = key;
+  victim->color = color;
+  victim->max_w = max_w;
+  victim->w = w;
+  victim->h = h;
+  victim->hash = hash;
+  victim->last_used = ++tc->clock;
+  if (out_w)
+    *out_w = w;
+  if (out_h)
+    *out_h = h;
+  return tex;
+}
+
+void text_cache_draw(TextCache *tc, const char *text, SDL_Color color, int x,
+                     int y, int max_w) {
+  int w, h;
+  SDL_Texture *tex = text_cache_get(tc, text, color, max_w, &w, &h);
+  if (tex) {
+    SDL_Rect dest = {x, y, w, h};
+    SDL_RenderCopy(tc->renderer, tex, NULL, &dest);
+  }
+}
@@ -0,0 +1,123 @@
+#include "texture_pool.h"
+#include <string.h>
+
+// --- Internal helpers ---
+
+static int align_size(int size, int limit) {
+  int aligned = (size + TEXTURE_POOL_ALIGN - 1) / TEXTURE_POOL_ALIGN *
+                TEXTURE_POOL_ALIGN;
+  if (limit > 0 && aligned > limit)
+    aligned = size > limit ? size : limit;
+  return aligned;
+}
+
+static void remove_idle(TexturePool *pool, int i) {
+  memmove(&pool->idle[i], &pool->idle[i + 1],
+          (pool->idle_count - i - 1) * sizeof(PoolTexture));
+  pool->idle_count--;
+}
+
+// --- Public API ---
+
+void texture_pool_init(TexturePool *pool, SDL_Renderer *renderer,
+                       Uint32 format, int max_w, int max_h) {
+  memset(pool, 0, sizeof(TexturePool));
+  pool->renderer = renderer;
+  pool->format = format;
+  pool->max_w = max_w;
+  pool->max_h = max_h;
+}
+
+void texture_pool_clear(TexturePool *pool) {
+  for (int i = 0; i < pool->idle_count; i++)
+    SDL_DestroyTexture(pool->idle[i].texture);
+  pool->idle_count = 0;
+}
+
+SDL_Texture *texture_pool_acquire(TexturePool *pool, int w, int h) {
+  if (w <= 0 || h <= 0)
+    return NULL;
+
+  // Smallest idle texture that fits, as long as it doesn't waste more than
+  // the image itself takes
+  int best = -1;
+  long best_area = 0;
+  long want = (long)align_size(w, pool->max_w) * align_size(h, pool->max_h);
+  for (int i = 0; i < pool->idle_count; i++) {
+    PoolTexture *t = &pool->idle[i];
+    long area = (long)t->w * t->h;
+    if (t->w < w || t->h < h || area > 2 * want)
+      continue;
+    if (best < 0 || area < best_area) {
+      best = i;
+      best_area = area;
+    }
+  }
+  if (best >= 0) {
+    SDL_Texture *texture = pool->idle[best].texture;
+    remove_idle(pool, best);
+    pool->reused++;
+    return texture;
+  }
+
+  SDL_Texture *texture = SDL_CreateTexture(
+      pool->renderer, pool->format, SDL_TEXTUREACCESS_STREAMING,
+      align_size(w, pool->max_w), align_size(h, pool->max_h));
+  if (texture)
+    pool->created++;
+  return texture;
+}
+
+void texture_pool_release(TexturePool *pool, SDL_Texture *texture) {
+  if (!texture)
+    return;
+  int w, h;
+  if (SDL_QueryTexture(texture, NULL, NULL, &w, &h) != 0) {
+    SDL_DestroyTexture(texture);
+    return;
+  }
+  // Back to SDL's default, so the next page doesn't inherit this one's mode
+  SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+  if (pool->idle_count == TEXTURE_POOL_IDLE) {
+    SDL_DestroyTexture(pool->idle[0].texture);
+    remove_idle(pool, 0);
+  }
+  pool->idle[pool->idle_count].texture = texture;
+  pool->idle[pool->idle_count].w = w;
+  pool->idle[pool->idle_count].h = h;
+  pool->idle_count++;
+}
+
+int texture_pool_upload(TexturePool *pool, SDL_Texture *texture,
+                        const SDL_Surface *src, int y0, int rows) {
+  int tex_w, tex_h;
+  if (!texture || SDL_QueryTexture(texture, NULL, NULL, &tex_w, &tex_h) != 0)
+    return -1;
+  if (rows > tex_h)
+    rows = tex_h;
+  int w = src->w < tex_w ? src->w : tex_w;
+  int bpp = src->format->BytesPerPixel;
+  const Uint8 *pixels = (const Uint8 *)src->pixels + (size_t)y0 * src->pitch;
+
+  // Pages with transparency composite over the background like an
+  // SDL_CreateTextureFromSurface() texture would; opaque ones are copied
+  SDL_BlendMode mode = SDL_BLENDMODE_NONE;
+  SDL_GetSurfaceBlendMode((SDL_Surface *)src, &mode);
+  SDL_SetTextureBlendMode(texture, mode);
+
+  SDL_Rect rect = {0, 0, w, rows};
+  if (SDL_UpdateTexture(texture, &rect, pixels, src->pitch) != 0)
+    return -1;
+
+  // Repeat the last column and row once into the margin
+  if (w < tex_w) {
+    SDL_Rect col = {w, 0, 1, rows};
+    SDL_UpdateTexture(texture, &col, pixels + (w - 1) * bpp, src->pitch);
+  }
+  if (rows < tex_h) {
+    SDL_Rect row = {0, rows, w, 1};
+    SDL_UpdateTexture(texture, &row,
+                      pixels + (size_t)(rows - 1) * src->pitch, src->pitch);
+  }
+  return 0;
+}